@@ -0,0 +1,91 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "sl_struct.h"
+
+namespace sl
+{
+
+//! Number of frames kept in the marker timeline
+constexpr uint32_t kReflexTimelineSize = 64;
+//! Covers all markers up to and including PC latency ping
+constexpr uint32_t kReflexTimelineMarkerCount = 9;
+
+//! Timestamps (in microseconds, CPU clock) recorded for each marker in a single frame
+//!
+//! Zero means marker was not provided for the frame
+struct ReflexFrameTimeline
+{
+    uint64_t frameID{};
+    uint64_t markerTimeUs[kReflexTimelineMarkerCount]{};
+};
+
+//! Latency distribution for one marker pair, all values in microseconds
+struct ReflexLatencyPercentiles
+{
+    uint64_t numSamples{};
+    uint32_t meanUs{};
+    uint32_t p50Us{};
+    uint32_t p95Us{};
+    uint32_t p99Us{};
+    uint32_t maxUs{};
+};
+
+//! Optional output, chain it to `sl::ReflexState` when calling `slReflexGetState`
+//!
+//! Filled in place, no allocations are made by SL.
+//!
+// {B723D3AA-C2F0-42E8-8BD8-E754E310158D}
+SL_STRUCT(ReflexLatencyStats, StructType({ 0xb723d3aa, 0xc2f0, 0x42e8, { 0x8b, 0xd8, 0xe7, 0x54, 0xe3, 0x10, 0x15, 0x8d } }), kStructVersion1)
+    //! Simulation start to present end
+    ReflexLatencyPercentiles simToPresent{};
+    //! Render submit start to present end
+    ReflexLatencyPercentiles renderSubmitToPresent{};
+    //! Input sample to present end
+    ReflexLatencyPercentiles inputToPresent{};
+    //! Last kReflexTimelineSize frames, oldest first
+    ReflexFrameTimeline timeline[kReflexTimelineSize]{};
+
+    //! IMPORTANT: New members go here or if optional can be chained in a new struct, see sl_struct.h for details
+};
+
+enum class ReflexStatsExportFormat : uint32_t
+{
+    eCSV,
+    eJSON
+};
+
+//! Optional input, pass to `slReflexSetOptions` (chained or on its own) to dump
+//! the current timeline and latency histograms to a file
+//!
+// {D4AD3457-526C-486E-BA8F-69A88694339C}
+SL_STRUCT(ReflexStatsExport, StructType({ 0xd4ad3457, 0x526c, 0x486e, { 0xba, 0x8f, 0x69, 0xa8, 0x86, 0x94, 0x33, 0x9c } }), kStructVersion1)
+    //! Full path to the output file
+    const wchar_t* path{};
+    ReflexStatsExportFormat format = ReflexStatsExportFormat::eCSV;
+
+    //! IMPORTANT: New members go here or if optional can be chained in a new struct, see sl_struct.h for details
+};
+
+}
@@ -124,6 +124,8 @@ project "sl.interposer"
 		"./source/core/sl.param/**.cpp",
 		"./source/core/sl.log/**.h",
 		"./source/core/sl.log/**.cpp",
+		"./source/core/sl.trace/**.h",
+		"./source/core/sl.trace/**.cpp",
 		"./source/core/sl.exception/**.h",
 		"./source/core/sl.exception/**.cpp",
 		"./source/core/sl.security/**.h",
@@ -160,6 +162,7 @@ project "sl.interposer"
 	vpaths { ["api"] = {"./source/core/sl.api/**.h","./source/core/sl.api/**.cpp"}}
 	vpaths { ["include"] = {"./include/**.h"}}
 	vpaths { ["log"] = {"./source/core/sl.log/**.h","./source/core/sl.log/**.cpp"}}
+	vpaths { ["trace"] = {"./source/core/sl.trace/**.h","./source/core/sl.trace/**.cpp"}}
 	vpaths { ["exception"] = {"./source/core/sl.exception/**.h","./source/core/sl.exception/**.cpp"}}	
 	vpaths { ["params"] = {"./source/core/sl.param/**.h","./source/core/sl.param/**.cpp"}}
 	vpaths { ["security"] = {"./source/core/sl.security/**.h","./source/core/sl.security/**.cpp"}}
@@ -230,6 +233,7 @@ function pluginBasicSetup(name)
 	files { 
 		"./source/core/sl.api/**.h",
 		"./source/core/sl.log/**.h",		
+		"./source/core/sl.trace/**.h",
 		"./source/core/sl.ota/**.h",		
 		"./source/core/sl.security/**.h",
 		"./source/core/sl.security/**.cpp",
@@ -246,6 +250,7 @@ function pluginBasicSetup(name)
 	
 	vpaths { ["api"] = {"./source/core/sl.api/**.h"}}
 	vpaths { ["log"] = {"./source/core/sl.log/**.h","./source/core/sl.log/**.cpp"}}
+	vpaths { ["trace"] = {"./source/core/sl.trace/**.h"}}
 	vpaths { ["ota"] = {"./source/core/sl.ota/**.h", "./source/core/sl.ota/**.cpp"}}	
 	vpaths { ["file"] = {"./source/core/sl.file/**.h", "./source/core/sl.file/**.cpp"}}	
 	vpaths { ["extra"] = {"./source/core/sl.extra/**.h", "./source/core/sl.extra/**.cpp"}}		
@@ -338,5 +343,22 @@ project "sl.imgui"
 	libdirs {externaldir .."vulkan/Lib"}
 
 	links { "d3d11.lib", "d3d12.lib", "vulkan-1.lib"}
+
+project "sl.nis.cpu"
+	kind "StaticLib"
+	targetdir (ROOT .. "_artifacts/%{prj.name}/%{cfg.buildcfg}_%{cfg.platform}")
+	objdir (ROOT .. "_artifacts/%{prj.name}/%{cfg.buildcfg}_%{cfg.platform}")
+	characterset ("MBCS")
+	staticruntime "off"
+
+	-- Device-less NIS path only, sl.nis itself needs NIS_shaders.h generated by nis_compile.py so it stays out of the solution
+	files {
+		"./source/plugins/sl.nis/nisCPU.h",
+		"./source/plugins/sl.nis/nisCPU.cpp",
+		"./source/plugins/sl.nis/NIS/*.h"
+	}
+
+	vpaths { ["NIS"] = {"./source/plugins/sl.nis/NIS/*.h"}}
+	vpaths { ["impl"] = {"./source/plugins/sl.nis/nisCPU.h", "./source/plugins/sl.nis/nisCPU.cpp" }}
 	
 group ""
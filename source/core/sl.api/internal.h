@@ -29,6 +29,7 @@
 #endif
 
 #include "include/sl_struct.h"
+#include "source/core/sl.log/log.h"
 
 // Forward defines so we can reduce the overall number of includes
 struct NVSDK_NGX_Parameter;
@@ -87,13 +88,28 @@ struct DECLSPEC_UUID("ADEC44E2-61F0-45C3-AD9F-1B37379284FF") StreamlineRetrieveB
 namespace sl
 {
 
+//! Way beyond any sane chain, deeper ones are most likely cyclic or pointing to garbage
+constexpr uint32_t kMaxStructChainDepth = 4096;
+
+//! Next structure in the chain or null once the chain gets too deep, a cyclic chain always ends up here
+inline const BaseStructure* nextStruct(const BaseStructure* base, uint32_t& depth)
+{
+    if (++depth == kMaxStructChainDepth)
+    {
+        SL_LOG_ERROR_ONCE("Structure chain is deeper than %u, most likely cyclic - ignoring the rest of it", kMaxStructChainDepth);
+        return nullptr;
+    }
+    return base->next;
+}
+
 template<typename T>
 T* findStruct(const void* ptr)
 {
     auto base = static_cast<const BaseStructure*>(ptr);
+    uint32_t depth = 0;
     while (base && base->structType != T::s_structType)
     {
-        base = base->next;
+        base = nextStruct(base, depth);
     }
     return (T*)base;
 }
@@ -102,9 +118,10 @@ template<typename T>
 T* findStruct(void* ptr)
 {
     auto base = static_cast<const BaseStructure*>(ptr);
+    uint32_t depth = 0;
     while (base && base->structType != T::s_structType)
     {
-        base = base->next;
+        base = nextStruct(base, depth);
     }
     return (T*)base;
 }
@@ -116,27 +133,29 @@ T* findStruct(const void** ptr, uint32_t count)
     for (uint32_t i = 0; base == nullptr && i < count; i++)
     {
         base = static_cast<const BaseStructure*>(ptr[i]);
+        uint32_t depth = 0;
         while (base && base->structType != T::s_structType)
         {
-            base = base->next;
+            base = nextStruct(base, depth);
         }
     }
     return (T*)base;
 }
 
-template<typename T>
-bool findStructs(const void** ptr, uint32_t count, std::vector<T*>& structs)
+template<typename T, typename Allocator>
+bool findStructs(const void** ptr, uint32_t count, std::vector<T*, Allocator>& structs)
 {
     for (uint32_t i = 0; i < count; i++)
     {
         auto base = static_cast<const BaseStructure*>(ptr[i]);
+        uint32_t depth = 0;
         while (base)
         {
             if (base->structType == T::s_structType)
             {
                 structs.push_back((T*)base);
             }
-            base = base->next;
+            base = nextStruct(base, depth);
         }
     }
     return structs.size() > 0;
@@ -162,6 +181,8 @@ namespace api
 // Core API, each plugin must implement these
 using PFuncOnPluginLoad = bool(sl::param::IParameters* params, const char* loaderJSON, const char** pluginJSON);
 using PFuncOnPluginStartup = bool(const char* loaderJSON, void* device);
+// Optional, plugins which export it get binary loader config (see loaderConfig.h) instead of JSON text
+using PFuncOnPluginSetLoaderConfig = bool(const void* config, size_t size);
 using PFuncOnPluginShutdown = void(void);
 using PFuncGetPluginFunction = void* (const char* name);
 
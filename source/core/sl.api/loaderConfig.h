@@ -0,0 +1,200 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+#include "include/sl.h"
+#include "include/sl_version.h"
+
+namespace sl
+{
+
+namespace api
+{
+
+//! Flat binary config passed from the plugin manager to plugins which export 'slOnPluginSetLoaderConfig'
+//!
+//! Fixed POD header followed by a table of null terminated strings referenced by offset
+//! from the start of the blob, plugins read values in place without any parsing.
+//!
+//! Plugins which do not export 'slOnPluginSetLoaderConfig' keep receiving the loader JSON
+//! text in 'slOnPluginLoad' and 'slOnPluginStartup' exactly as before.
+constexpr uint32_t kLoaderConfigMagic = 0x434c4c53; // 'SLLC'
+constexpr uint32_t kLoaderConfigVersion1 = 1;
+//! Sanity limit, anything larger is considered corrupted
+constexpr uint32_t kLoaderConfigMaxSize = 1 << 20;
+
+struct LoaderConfigString
+{
+    uint32_t offset{};
+    uint32_t length{};
+};
+
+//! IMPORTANT: New members go at the end, older plugins simply ignore them
+struct LoaderConfigHeader
+{
+    uint32_t magic = kLoaderConfigMagic;
+    uint32_t version = kLoaderConfigVersion1;
+    //! Header plus string table, in bytes
+    uint32_t size{};
+    uint32_t deviceType{};
+    Version host{};
+    Version pluginManager{};
+    Version api{};
+    int32_t appId{};
+    uint32_t engineType{};
+    uint64_t preferenceFlags{};
+    uint32_t interposerEnabled{};
+    uint32_t forceNonNVDA{};
+    LoaderConfigString engineVersion{};
+    LoaderConfigString projectId{};
+    uint32_t pathCount{};
+    //! Offset of 'pathCount' consecutive LoaderConfigString entries
+    uint32_t pathsOffset{};
+};
+
+//! Serializes header and strings into a single blob, offsets and size in the header are filled in here
+inline void writeLoaderConfig(const LoaderConfigHeader& fields, const std::string& engineVersion, const std::string& projectId, const std::vector<std::string>& paths, std::vector<uint8_t>& blob)
+{
+    auto header = fields;
+    header.magic = kLoaderConfigMagic;
+    header.version = kLoaderConfigVersion1;
+    header.pathCount = (uint32_t)paths.size();
+    header.pathsOffset = sizeof(LoaderConfigHeader);
+
+    size_t size = sizeof(LoaderConfigHeader) + paths.size() * sizeof(LoaderConfigString);
+    std::vector<LoaderConfigString> pathStrings(paths.size());
+    std::string strings;
+    auto addString = [&size, &strings](const std::string& str, LoaderConfigString& location)->void
+    {
+        location.offset = uint32_t(size + strings.size());
+        location.length = (uint32_t)str.size();
+        strings.append(str);
+        strings.push_back(0);
+    };
+    addString(engineVersion, header.engineVersion);
+    addString(projectId, header.projectId);
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        addString(paths[i], pathStrings[i]);
+    }
+    header.size = uint32_t(size + strings.size());
+
+    blob.resize(header.size);
+    auto dst = blob.data();
+    memcpy(dst, &header, sizeof(header));
+    if (!pathStrings.empty())
+    {
+        memcpy(dst + header.pathsOffset, pathStrings.data(), pathStrings.size() * sizeof(LoaderConfigString));
+    }
+    memcpy(dst + size, strings.data(), strings.size());
+}
+
+//! Plugin side view of the loader config
+//!
+//! Blob is copied once since the plugin manager does not keep it alive, all getters
+//! return values in place.
+class LoaderConfig
+{
+public:
+    //! Returns false if data is not a binary loader config or if it is malformed
+    //!
+    //! Nothing is read outside of [data, data + size), blob can be larger than the header
+    //! says (newer plugin manager) but never smaller.
+    bool init(const void* data, size_t size)
+    {
+        m_blob.clear();
+        if (!data || size < sizeof(LoaderConfigHeader) || size > kLoaderConfigMaxSize) return false;
+
+        auto bytes = (const uint8_t*)data;
+        LoaderConfigHeader header{};
+        memcpy(&header, bytes, sizeof(header));
+        if (header.magic != kLoaderConfigMagic || header.version < kLoaderConfigVersion1 || header.size < sizeof(header) || header.size > size) return false;
+
+        m_blob.assign(bytes, bytes + header.size);
+        if (!isValid(header.engineVersion) || !isValid(header.projectId) ||
+            header.pathsOffset > header.size || header.pathCount > (header.size - header.pathsOffset) / sizeof(LoaderConfigString))
+        {
+            m_blob.clear();
+            return false;
+        }
+        for (uint32_t i = 0; i < header.pathCount; i++)
+        {
+            if (!isValid(getPathString(i)))
+            {
+                m_blob.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool isInitialized() const { return !m_blob.empty(); }
+
+    inline const Version& getHostVersion() const { return getHeader().host; }
+    inline const Version& getPluginManagerVersion() const { return getHeader().pluginManager; }
+    inline const Version& getAPIVersion() const { return getHeader().api; }
+    inline int getAppId() const { return getHeader().appId; }
+    inline RenderAPI getDeviceType() const { return (RenderAPI)getHeader().deviceType; }
+    inline EngineType getEngineType() const { return (EngineType)getHeader().engineType; }
+    inline const char* getEngineVersion() const { return getString(getHeader().engineVersion); }
+    inline const char* getProjectId() const { return getString(getHeader().projectId); }
+    inline PreferenceFlags getPreferenceFlags() const { return (PreferenceFlags)getHeader().preferenceFlags; }
+    inline bool isInterposerEnabled() const { return getHeader().interposerEnabled != 0; }
+    inline bool isForceNonNVDA() const { return getHeader().forceNonNVDA != 0; }
+    inline uint32_t getPathCount() const { return getHeader().pathCount; }
+    inline const char* getPath(uint32_t index) const { return index < getPathCount() ? getString(getPathString(index)) : ""; }
+
+private:
+
+    inline const LoaderConfigHeader& getHeader() const
+    {
+        static const LoaderConfigHeader s_empty{};
+        return m_blob.empty() ? s_empty : *(const LoaderConfigHeader*)m_blob.data();
+    }
+
+    inline LoaderConfigString getPathString(uint32_t index) const
+    {
+        LoaderConfigString str{};
+        memcpy(&str, m_blob.data() + getHeader().pathsOffset + index * sizeof(LoaderConfigString), sizeof(str));
+        return str;
+    }
+
+    inline bool isValid(const LoaderConfigString& str) const
+    {
+        return str.offset < m_blob.size() && str.length < m_blob.size() - str.offset && m_blob[str.offset + str.length] == 0;
+    }
+
+    inline const char* getString(const LoaderConfigString& str) const
+    {
+        return m_blob.empty() ? "" : (const char*)m_blob.data() + str.offset;
+    }
+
+    std::vector<uint8_t> m_blob{};
+};
+
+} // namespace api
+} // namespace sl
@@ -34,12 +34,14 @@
 #include <unistd.h>
 #endif
 #include <chrono>
+#include <thread>
 
 #include "include/sl.h"
 #include "include/sl_hooks.h"
 #include "internal.h"
 #include "source/core/sl.exception/exception.h"
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.trace/trace.h"
 #include "source/core/sl.file/file.h"
 #include "source/core/sl.param/parameters.h"
 #include "source/core/sl.interposer/hook.h"
@@ -85,17 +87,28 @@ struct FrameHandleImplementation : public FrameToken
     virtual operator uint32_t() const override final { return counter.load(); };
 
     std::atomic<uint32_t> counter{};
+    //! Position in the token ring when this token was issued, used to publish the counter and to detect stale tokens
+    std::atomic<uint32_t> sequence{};
+    //! Full frame index and ring position packed as (counter << 32) | sequence, written with a single store when issued
+    std::atomic<uint64_t> issued{};
+    //! Ring position current at the last API call made with this token, only tracked when validating frame tokens
+    std::atomic<uint32_t> lastUse{};
 };
 
 //! Normally host would work with no more than 2 frames at the same time but sl.reflex sometimes 
-//! needs to send markers for previous and next frame so the total number of inflight frames can be higher
-constexpr uint32_t kMaxNumFrameHandles = 6;
+//! needs to send markers for previous and next frame and with frame generation, deep render-ahead and
+//! multi-threaded recording the total number of inflight frames can be much higher
+#ifndef SL_MAX_FRAME_TOKENS
+#define SL_MAX_FRAME_TOKENS 64
+#endif
+constexpr uint32_t kMaxNumFrameHandles = SL_MAX_FRAME_TOKENS;
+static_assert((kMaxNumFrameHandles & (kMaxNumFrameHandles - 1)) == 0, "frame token ring size must be a power of two so the sequence can wrap around");
 
 struct APIContext
 {
-    std::mutex mtxFrameHandle{};
-    uint32_t frameCounter = 0;
-    uint32_t frameHandleIndex = 0;
+    //! Current token packed as (counter << 32) | sequence, token lives at 'sequence % kMaxNumFrameHandles'
+    std::atomic<uint64_t> frameTokenState{};
+    bool validateFrameTokens = false;
     FrameHandleImplementation frameHandles[kMaxNumFrameHandles];
 
     std::map<Feature, std::pair<size_t, BufferType*>> requiredTags;
@@ -108,6 +121,52 @@ struct APIContext
 
 APIContext s_ctx;
 
+//! Reports frame tokens which were not issued by us or which are about to be reissued while host still uses them
+//!
+//! NOTE: Once a slot is reissued the host's reference reads the new frame index, so a late call cannot be told apart
+//! from the new owner. Each call therefore records where in the ring it happened and 'slReportReissuedFrameToken'
+//! catches the reissue itself.
+inline void slValidateFrameToken(const FrameToken& frame, const char* function)
+{
+    if (!s_ctx.validateFrameTokens) return;
+
+    auto address = (const void*)&frame;
+    if (address < (const void*)s_ctx.frameHandles || address >= (const void*)(s_ctx.frameHandles + kMaxNumFrameHandles))
+    {
+        SL_LOG_ERROR("'%s' called with frame token 0x%llx which was not obtained from 'slGetNewFrameToken'", function, address);
+        return;
+    }
+    auto token = const_cast<FrameHandleImplementation*>(static_cast<const FrameHandleImplementation*>(&frame));
+    auto current = uint32_t(s_ctx.frameTokenState.load(std::memory_order_acquire));
+    auto issued = token->issued.load(std::memory_order_acquire);
+    auto frameIndex = (uint32_t)frame;
+    if (uint32_t(issued >> 32) != frameIndex)
+    {
+        // Host read the counter while the slot was being reissued
+        SL_LOG_ERROR("'%s' called with frame token %u while it is being reissued for frame %u - please use a fresh token from 'slGetNewFrameToken'",
+            function, frameIndex, uint32_t(issued >> 32));
+        return;
+    }
+    token->lastUse.store(current, std::memory_order_relaxed);
+    auto age = current - uint32_t(issued);
+    if (age > kMaxNumFrameHandles / 2)
+    {
+        SL_LOG_WARN("'%s' called with frame token %u issued %u tokens ago, it will be reissued for a new frame after %u more - please use a fresh token from 'slGetNewFrameToken'",
+            function, frameIndex, age, kMaxNumFrameHandles - age);
+    }
+}
+
+//! Called right before a slot is reissued, reports the outgoing token if host was still using it late in its lifetime
+inline void slReportReissuedFrameToken(const FrameHandleImplementation& token, uint32_t counter)
+{
+    auto issued = token.issued.load(std::memory_order_acquire);
+    auto lastUse = token.lastUse.load(std::memory_order_relaxed);
+    // Never issued, never used or the last use was early enough that host clearly moved on to newer tokens
+    if (!issued || lastUse - uint32_t(issued) <= kMaxNumFrameHandles / 2) return;
+    SL_LOG_ERROR("Frame token %u was still used %u tokens after it was issued and is now reissued for frame %u - any further use will silently report the new frame",
+        uint32_t(issued >> 32), lastUse - uint32_t(issued), counter);
+}
+
 sl::Result slInit(const Preferences &pref, uint64_t sdkVersion)
 {
     //! IMPORTANT:
@@ -148,6 +207,12 @@ sl::Result slInit(const Preferences &pref, uint64_t sdkVersion)
                 auto level = std::clamp(config.logLevel, 0U, 2U);
                 log->setLogLevel((LogLevel)level);
                 log->setLogMessageDelay(config.logMessageDelayMs);
+                s_ctx.validateFrameTokens = config.validateFrameTokens;
+                if (!config.tracePath.empty())
+                {
+                    trace::getInterface()->setEnabled(true);
+                    SL_LOG_INFO("Tracing enabled, events will be saved to '%s' on shutdown", config.tracePath.c_str());
+                }
                 SL_LOG_HINT("Overriding interposer settings with values from %S\\sl.interposer.json", sl::interposer::getInterface()->getConfigPath().c_str());
                 if (config.waitForDebugger)
                 {
@@ -195,6 +260,7 @@ sl::Result slInit(const Preferences &pref, uint64_t sdkVersion)
             param::getInterface()->set(param::global::kPFunAllocateResource, pref.allocateCallback);
             param::getInterface()->set(param::global::kPFunReleaseResource, pref.releaseCallback);
             param::getInterface()->set(param::global::kLogInterface, log::getInterface());
+            param::getInterface()->set(param::global::kTraceInterface, trace::getInterface());
 
             // Enumerate plugins and check if they are supported or not
             return manager->loadPlugins();
@@ -239,8 +305,18 @@ Result slShutdown()
     }
     manager->unloadPlugins();
 
+#ifndef SL_PRODUCTION
+    if (trace::getInterface()->isEnabled())
+    {
+        auto tracePath = sl::interposer::getInterface()->getConfig().tracePath;
+        trace::getInterface()->logLatencySummary();
+        trace::getInterface()->exportChromeJSON(extra::toWStr(tracePath).c_str());
+    }
+#endif
+
     plugin_manager::destroyInterface();
     param::destroyInterface();
+    trace::destroyInterface();
     log::destroyInterface();
     interposer::destroyInterface();
 
@@ -279,12 +355,18 @@ Result slSetTag(const sl::ViewportHandle& viewport, const sl::ResourceTag* tags,
     static_assert(offsetof(sl::ResourceTag, extent) == 48, "new elements can only be added at the end of each structure");
     static_assert(offsetof(sl::Resource, reserved) == 104, "new elements can only be added at the end of each structure");
 
+    // NOTE: Trace scope has a destructor so it cannot live in the same function as the SEH block
+    auto setTag = [&viewport, tags, numTags, cmdBuffer]()->Result
+    {
+        SL_TRACE_SCOPE_ARG("slSetTag", numTags);
+        SL_CHECK(slValidateState());
+        const sl::plugin_manager::FeatureContext* ctx;
+        SL_CHECK(slValidateFeatureContext(kFeatureCommon, ctx));
+        if (!tags || numTags == 0) return Result::eErrorInvalidParameter;
+        return ctx->setTag(viewport, tags, numTags, cmdBuffer);
+    };
     SL_EXCEPTION_HANDLE_START;
-    SL_CHECK(slValidateState());
-    const sl::plugin_manager::FeatureContext* ctx;
-    SL_CHECK(slValidateFeatureContext(kFeatureCommon, ctx));
-    if (!tags || numTags == 0) return Result::eErrorInvalidParameter;
-    return ctx->setTag(viewport, tags, numTags, cmdBuffer);
+    return setTag();
     SL_EXCEPTION_HANDLE_END_RETURN(Result::eErrorExceptionHandler);
 }
 
@@ -298,15 +380,21 @@ Result slSetConstants(const Constants& values, const FrameToken& frame, const Vi
     //! that new element(s) are NOT added in the middle of a structure.
     static_assert(offsetof(sl::Constants, motionVectorsJittered) == 450, "new elements can only be added at the end of each structure");
 
-    SL_EXCEPTION_HANDLE_START;
-    SL_CHECK(slValidateState());
-    const sl::plugin_manager::FeatureContext* ctx;
-    if (slValidateFeatureContext(kFeatureMTSS_G, ctx) == sl::Result::eOk && ctx->setConstants != nullptr)
+    auto setConstants = [&values, &frame, &viewport]()->Result
     {
-        ctx->setConstants(values, frame, viewport);
-    }
-    SL_CHECK(slValidateFeatureContext(kFeatureCommon, ctx));
-    return ctx->setConstants(values, frame, viewport);
+        SL_TRACE_SCOPE_ARG("slSetConstants", (uint32_t)frame);
+        SL_CHECK(slValidateState());
+        slValidateFrameToken(frame, "slSetConstants");
+        const sl::plugin_manager::FeatureContext* ctx;
+        if (slValidateFeatureContext(kFeatureMTSS_G, ctx) == sl::Result::eOk && ctx->setConstants != nullptr)
+        {
+            ctx->setConstants(values, frame, viewport);
+        }
+        SL_CHECK(slValidateFeatureContext(kFeatureCommon, ctx));
+        return ctx->setConstants(values, frame, viewport);
+    };
+    SL_EXCEPTION_HANDLE_START;
+    return setConstants();
     SL_EXCEPTION_HANDLE_END_RETURN(Result::eErrorExceptionHandler);
 }
 
@@ -342,11 +430,17 @@ Result slFreeResources(sl::Feature feature, const sl::ViewportHandle& viewport)
 
 Result slEvaluateFeature(sl::Feature feature, const sl::FrameToken& frame, const sl::BaseStructure** inputs, uint32_t numInputs, sl::CommandBuffer* cmdBuffer)
 {
+    auto evaluate = [feature, &frame, inputs, numInputs, cmdBuffer]()->Result
+    {
+        SL_TRACE_SCOPE_ARG("slEvaluateFeature", feature);
+        SL_CHECK(slValidateState());
+        slValidateFrameToken(frame, "slEvaluateFeature");
+        const sl::plugin_manager::FeatureContext* ctx;
+        SL_CHECK(slValidateFeatureContext(sl::kFeatureCommon, ctx));
+        return ctx->evaluate(feature, frame, inputs, numInputs, cmdBuffer);
+    };
     SL_EXCEPTION_HANDLE_START;
-    SL_CHECK(slValidateState());
-    const sl::plugin_manager::FeatureContext* ctx;
-    SL_CHECK(slValidateFeatureContext(sl::kFeatureCommon, ctx));
-    return ctx->evaluate(feature, frame, inputs, numInputs, cmdBuffer);
+    return evaluate();
     SL_EXCEPTION_HANDLE_END_RETURN(Result::eErrorExceptionHandler);
 }
 
@@ -990,21 +1084,45 @@ Result slGetNewFrameToken(FrameToken*& handle, const uint32_t* frameIndex)
     {
         SL_CHECK(slValidateState());
 
-        std::scoped_lock lock(s_ctx.mtxFrameHandle);
-
         //! Two scenarios:
         //! 
-        //! - If frame index is not provided we advance our internal counter and return next token
+        //! - If frame index is not provided we advance the counter and return next token
         //! - If frame index is provided then reuse the previous one if index is the same
         //! 
         //! Host can request multiple frame tokens with an identical frame index within the same frame, this is totally valid.
-        if (!frameIndex || (*frameIndex != s_ctx.frameHandles[s_ctx.frameHandleIndex].counter.load()))
+        //! 
+        //! Counter and ring position are advanced together with a single CAS so concurrent callers
+        //! asking for the same frame index always end up with the same token.
+        auto state = s_ctx.frameTokenState.load(std::memory_order_acquire);
+        while (!frameIndex || *frameIndex != uint32_t(state >> 32))
         {
-            s_ctx.frameHandleIndex = (s_ctx.frameHandleIndex + 1) % kMaxNumFrameHandles;
-            s_ctx.frameHandles[s_ctx.frameHandleIndex].counter.store(frameIndex ? *frameIndex : ++s_ctx.frameCounter);
+            auto sequence = uint32_t(state) + 1;
+            auto counter = frameIndex ? *frameIndex : uint32_t(state >> 32) + 1;
+            auto next = (uint64_t(counter) << 32) | sequence;
+            if (s_ctx.frameTokenState.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                auto& token = s_ctx.frameHandles[sequence % kMaxNumFrameHandles];
+                if (s_ctx.validateFrameTokens)
+                {
+                    slReportReissuedFrameToken(token, counter);
+                }
+                token.counter.store(counter, std::memory_order_relaxed);
+                token.issued.store(next, std::memory_order_relaxed);
+                token.lastUse.store(sequence, std::memory_order_relaxed);
+                token.sequence.store(sequence, std::memory_order_release);
+                state = next;
+                SL_TRACE_INSTANT(trace::kFrameBoundaryName, counter);
+                break;
+            }
         }
 
-        handle = &s_ctx.frameHandles[s_ctx.frameHandleIndex];
+        auto& token = s_ctx.frameHandles[uint32_t(state) % kMaxNumFrameHandles];
+        // Another thread won the CAS but has not published the new counter yet, this is only ever a couple of stores away
+        while (int32_t(token.sequence.load(std::memory_order_acquire) - uint32_t(state)) < 0)
+        {
+            std::this_thread::yield();
+        }
+        handle = &token;
         return Result::eOk;
     };
     SL_EXCEPTION_HANDLE_START;
@@ -0,0 +1,149 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+
+namespace sl
+{
+namespace extra
+{
+
+//! Per thread scratch memory, large enough for the tags, transitions and similar lists built in a single SL call
+constexpr size_t kFrameArenaSize = 64 * 1024;
+
+//! Freed arena memory is filled with this pattern in non-production builds so use after free/reset stands out
+constexpr uint8_t kFrameArenaPoison = 0xdd;
+
+//! Thread local bump allocator for short lived containers on the per call paths
+//!
+//! Use through 'getFrameArena()' with std::pmr containers, for example
+//! 'std::pmr::vector<ResourceTag*> tags(extra::getFrameArena());'
+//!
+//! Deallocation is a no-op except for bookkeeping, the bump pointer rewinds as soon as everything
+//! allocated from the arena is released so nested temporaries within a single call never run out.
+//! Requests which do not fit fall back to the regular heap. 'beginFrame' is called at the frame
+//! token boundary and reclaims the whole arena, unless something allocated during the previous
+//! frame is still alive in which case the arena keeps growing until it is empty again.
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+    FrameArena() = default;
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    //! Returns false if allocations from the previous frame are still alive, arena is not reset in that case
+    bool beginFrame(uint32_t frame)
+    {
+        if (frame == m_frame) return true;
+        m_frame = frame;
+        if (m_numLive > 0) return false;
+        reset();
+        return true;
+    }
+
+    //! Number of allocations which did not fit and went to the heap, useful to tune 'kFrameArenaSize'
+    uint64_t getNumOverflows() const { return m_numOverflows; }
+    uint32_t getNumLive() const { return m_numLive; }
+    size_t getUsedBytes() const { return m_offset; }
+
+private:
+
+    void reset()
+    {
+#ifndef SL_PRODUCTION
+        if (m_buffer)
+        {
+            memset(m_buffer.get(), kFrameArenaPoison, m_offset);
+        }
+#endif
+        m_offset = 0;
+    }
+
+    inline bool owns(const void* p) const
+    {
+        return m_buffer && p >= m_buffer.get() && p < m_buffer.get() + kFrameArenaSize;
+    }
+
+    virtual void* do_allocate(size_t bytes, size_t alignment) override final
+    {
+        if (!m_buffer)
+        {
+            m_buffer = std::make_unique<uint8_t[]>(kFrameArenaSize);
+        }
+        auto offset = (m_offset + alignment - 1) & ~(alignment - 1);
+        if (alignment > alignof(std::max_align_t) || offset + bytes > kFrameArenaSize)
+        {
+            m_numOverflows++;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        m_offset = offset + bytes;
+        m_numLive++;
+        return m_buffer.get() + offset;
+    }
+
+    virtual void do_deallocate(void* p, size_t bytes, size_t alignment) override final
+    {
+        if (!owns(p))
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+            return;
+        }
+#ifndef SL_PRODUCTION
+        memset(p, kFrameArenaPoison, bytes);
+#endif
+        // Most recent allocation can be handed back right away, everything else once the arena is empty
+        if ((uint8_t*)p + bytes == m_buffer.get() + m_offset)
+        {
+            m_offset = (uint8_t*)p - m_buffer.get();
+        }
+        if (--m_numLive == 0)
+        {
+            m_offset = 0;
+        }
+    }
+
+    virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override final
+    {
+        return this == &other;
+    }
+
+    std::unique_ptr<uint8_t[]> m_buffer{};
+    size_t m_offset = 0;
+    uint32_t m_numLive = 0;
+    uint32_t m_frame = UINT32_MAX;
+    uint64_t m_numOverflows = 0;
+};
+
+//! Arena for the calling thread, each module has its own
+inline FrameArena* getFrameArena()
+{
+    thread_local FrameArena t_arena;
+    return &t_arena;
+}
+
+}
+}
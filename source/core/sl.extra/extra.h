@@ -30,6 +30,7 @@
 #include <cstring>
 #include <sstream>
 #include <atomic>
+#include <chrono>
 #include <cmath>
 #include <codecvt>
 #include <locale>
@@ -194,9 +195,128 @@ IKeyboard* getInterface();
 
 constexpr size_t kAverageMeterWindowSize = 120;
 
+//! P-square streaming quantile estimator (Jain and Chlamtac)
+//!
+//! Tracks single quantile over the entire stream with five markers, no allocations and constant time per sample.
+struct P2Quantile
+{
+    explicit P2Quantile(double p = 0.5) { reset(p); }
+
+    void reset(double p)
+    {
+        m_p = p;
+        m_count = 0;
+        m_increment[0] = 0.0;
+        m_increment[1] = p / 2.0;
+        m_increment[2] = p;
+        m_increment[3] = (1.0 + p) / 2.0;
+        m_increment[4] = 1.0;
+    }
+
+    void add(double x)
+    {
+        if (m_count < 5)
+        {
+            m_height[m_count++] = x;
+            if (m_count == 5)
+            {
+                std::sort(m_height, m_height + 5);
+                for (int i = 0; i < 5; i++)
+                {
+                    m_pos[i] = i + 1.0;
+                }
+                m_desired[0] = 1.0;
+                m_desired[1] = 1.0 + 2.0 * m_p;
+                m_desired[2] = 1.0 + 4.0 * m_p;
+                m_desired[3] = 3.0 + 2.0 * m_p;
+                m_desired[4] = 5.0;
+            }
+            return;
+        }
+
+        // Find the cell containing x, extend the extremes if needed
+        int k = 0;
+        if (x < m_height[0])
+        {
+            m_height[0] = x;
+        }
+        else if (x >= m_height[4])
+        {
+            m_height[4] = x;
+            k = 3;
+        }
+        else
+        {
+            while (x >= m_height[k + 1]) k++;
+        }
+        for (int i = k + 1; i < 5; i++)
+        {
+            m_pos[i] += 1.0;
+        }
+        for (int i = 0; i < 5; i++)
+        {
+            m_desired[i] += m_increment[i];
+        }
+
+        // Move middle markers towards their desired positions
+        for (int i = 1; i <= 3; i++)
+        {
+            auto d = m_desired[i] - m_pos[i];
+            if ((d >= 1.0 && m_pos[i + 1] - m_pos[i] > 1.0) || (d <= -1.0 && m_pos[i - 1] - m_pos[i] < -1.0))
+            {
+                int s = d >= 0.0 ? 1 : -1;
+                auto h = parabolic(i, s);
+                if (m_height[i - 1] < h && h < m_height[i + 1])
+                {
+                    m_height[i] = h;
+                }
+                else
+                {
+                    m_height[i] = m_height[i] + s * (m_height[i + s] - m_height[i]) / (m_pos[i + s] - m_pos[i]);
+                }
+                m_pos[i] += s;
+            }
+        }
+        m_count++;
+    }
+
+    double get() const
+    {
+        if (m_count == 0) return 0.0;
+        if (m_count <= 5)
+        {
+            // Not enough samples for the markers yet, pick directly from the sorted samples
+            double tmp[5];
+            memcpy(tmp, m_height, sizeof(double) * m_count);
+            std::sort(tmp, tmp + m_count);
+            auto i = std::min(size_t(m_p * m_count), size_t(m_count - 1));
+            return tmp[i];
+        }
+        return m_height[2];
+    }
+
+private:
+    inline double parabolic(int i, int s) const
+    {
+        return m_height[i] + s / (m_pos[i + 1] - m_pos[i - 1]) *
+            ((m_pos[i] - m_pos[i - 1] + s) * (m_height[i + 1] - m_height[i]) / (m_pos[i + 1] - m_pos[i]) +
+             (m_pos[i + 1] - m_pos[i] - s) * (m_height[i] - m_height[i - 1]) / (m_pos[i] - m_pos[i - 1]));
+    }
+
+    double m_p{};
+    uint64_t m_count{};
+    double m_height[5]{};
+    double m_pos[5]{};
+    double m_desired[5]{};
+    double m_increment[5]{};
+};
+
 //! IMPORTANT: Mainly not thread safe for performance reasons
 //! 
 //! Only selected "get" methods use atomics.
+//!
+//! Window is also kept sorted so min, max and any percentile over the window are constant time,
+//! tail percentiles over all samples since the last reset are estimated with P2Quantile.
 struct AverageValueMeter
 {
     AverageValueMeter()
@@ -212,12 +332,20 @@ struct AverageValueMeter
     {
         n = rhs.n.load();
         val = rhs.val.load();
-        sum = rhs.sum;
+        mean = rhs.mean.load();
+        windowMean = rhs.windowMean;
+        windowM2 = rhs.windowM2;
         memcpy(window, rhs.window, sizeof(double) * kAverageMeterWindowSize);
+        memcpy(sorted, rhs.sorted, sizeof(double) * kAverageMeterWindowSize);
+        p99 = rhs.p99;
+        p999 = rhs.p999;
 #ifdef SL_WINDOWS
         frequency = rhs.frequency;
         startTime = rhs.startTime;
         elapsedUs = rhs.elapsedUs;
+#else
+        startTime = rhs.startTime;
+        elapsedUs = rhs.elapsedUs;
 #endif
         return *this;
     }
@@ -227,12 +355,19 @@ struct AverageValueMeter
     {
         n = 0;
         val = 0;
-        sum = 0;
+        windowMean = 0;
+        windowM2 = 0;
         mean = 0;
         memset(window, 0, sizeof(double) * kAverageMeterWindowSize);
+        memset(sorted, 0, sizeof(double) * kAverageMeterWindowSize);
+        p99.reset(0.99);
+        p999.reset(0.999);
 #ifdef SL_WINDOWS
         startTime = {};
         elapsedUs = {};
+#else
+        startTime = {};
+        elapsedUs = {};
 #endif
     }
 
@@ -241,6 +376,8 @@ struct AverageValueMeter
     {
 #ifdef SL_WINDOWS
         QueryPerformanceCounter(&startTime);
+#else
+        startTime = std::chrono::steady_clock::now();
 #endif
     }
 
@@ -258,6 +395,12 @@ struct AverageValueMeter
             auto elapsedMs = elapsedUs.QuadPart / 1000.0;
             add(elapsedMs);
         }
+#else
+        if (startTime.time_since_epoch().count() > 0)
+        {
+            elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+            add(elapsedUs / 1000.0);
+        }
 #endif
     }
 
@@ -282,7 +425,11 @@ struct AverageValueMeter
         }
         return elapsedUs.QuadPart;
 #else
-        return 0;
+        if (startTime.time_since_epoch().count() > 0)
+        {
+            elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+        }
+        return elapsedUs;
 #endif
     }
 
@@ -291,40 +438,79 @@ struct AverageValueMeter
     //! avoiding using std vectors as much as possible.
     //! 
     //! NOT thread safe
+    //!
+    //! NaN/Inf samples are dropped, they cannot be ordered and would break the sorted window
     void add(double value)
     {
+        if (!std::isfinite(value)) return;
         val = value;
-        sum = sum + value;
         auto i = n.load() % kAverageMeterWindowSize;
+        auto count = std::min(n.load(), kAverageMeterWindowSize);
         if (n >= kAverageMeterWindowSize)
         {
-            sum = sum - window[i];
+            auto old = window[i];
+            // Welford update for 'value' replacing 'old', window size stays the same
+            auto prevMean = windowMean;
+            windowMean = prevMean + (value - old) / double(count);
+            windowM2 = windowM2 + (value - old) * (value - windowMean + old - prevMean);
+            // Value leaving the window is always present in the sorted copy
+            auto it = std::lower_bound(sorted, sorted + count, old);
+            memmove(it, it + 1, sizeof(double) * (sorted + count - it - 1));
+            count--;
+        }
+        else
+        {
+            auto delta = value - windowMean;
+            windowMean = windowMean + delta / double(count + 1);
+            windowM2 = windowM2 + delta * (value - windowMean);
         }
+        auto it = std::upper_bound(sorted, sorted + count, value);
+        memmove(it + 1, it, sizeof(double) * (sorted + count - it));
+        *it = value;
         window[i] = value;
+        p99.add(value);
+        p999.add(value);
         n++;
-        mean = sum / double(std::min(n.load(), kAverageMeterWindowSize));
+        mean = windowMean;
     }
 
     //! NOT thread safe
-    double getMedian()
+    //!
+    //! Percentile in [0,1] over the current window, 0.5 returns the same value as 'getMedian'
+    inline double getPercentile(double p) const
     {
-        double median = 0;
-        if (n > 0)
-        {
-            std::vector<double> tmp(window, window + std::min(n.load(),kAverageMeterWindowSize));
-            std::sort(tmp.begin(), tmp.end());
-            median = tmp[tmp.size() / 2];
-        }
-        return median;
+        auto count = std::min(n.load(), kAverageMeterWindowSize);
+        if (count == 0) return 0;
+        auto i = std::min(size_t(std::max(p, 0.0) * count), count - 1);
+        return sorted[i];
     }
 
+    //! NOT thread safe
+    inline double getMedian() const { return getPercentile(0.5); }
+    inline double getMin() const { return getPercentile(0.0); }
+    inline double getMax() const { return getPercentile(1.0); }
+
+    //! NOT thread safe
+    inline double getStdDev() const
+    {
+        auto count = std::min(n.load(), kAverageMeterWindowSize);
+        if (count == 0) return 0;
+        return sqrt(std::max(windowM2 / count, 0.0));
+    }
+
+    //! NOT thread safe
+    //!
+    //! Estimated over all samples since the last reset, not just the window
+    inline double getP99() const { return p99.get(); }
+    inline double getP999() const { return p999.get(); }
+
     //! NOT thread safe
     inline int64_t getElapsedTimeUs() const
     {
 #ifdef SL_WINDOWS
         return elapsedUs.QuadPart;
 #else
-        return 0;
+        return elapsedUs;
 #endif
     }
 
@@ -339,13 +525,20 @@ private:
     std::atomic<double> mean = 0;
     std::atomic<uint64_t> n = 0;
 
-    double sum{};
+    double windowMean{};
+    double windowM2{};
     double window[kAverageMeterWindowSize] = {};
+    double sorted[kAverageMeterWindowSize] = {};
+    P2Quantile p99{ 0.99 };
+    P2Quantile p999{ 0.999 };
 
 #ifdef SL_WINDOWS
     LARGE_INTEGER frequency{};
     LARGE_INTEGER startTime{};
     LARGE_INTEGER elapsedUs{};
+#else
+    std::chrono::steady_clock::time_point startTime{};
+    int64_t elapsedUs{};
 #endif
 };
 
@@ -172,15 +172,11 @@ HRESULT STDMETHODCALLTYPE D3D12GraphicsCommandList::Reset(ID3D12CommandAllocator
 {
     if (m_trackState)
     {
-        m_rootSignature = {};
         m_pso = pInitialState;
         m_so = {};
         m_numHeaps = {};
-        m_mapHandles = {};
-        m_mapCBV.clear();
-        m_mapSRV.clear();
-        m_mapUAV.clear();
-        m_mapConstants.clear();
+        m_compute.reset(nullptr);
+        m_graphics.reset(nullptr);
     }
     return m_base->Reset(pAllocator, pInitialState);
 }
@@ -189,15 +185,11 @@ void STDMETHODCALLTYPE D3D12GraphicsCommandList::ClearState(ID3D12PipelineState*
 {
     if (m_trackState)
     {
-        m_rootSignature = {};
         m_pso = pPipelineState;
         m_so = {};
         m_numHeaps = {};
-        m_mapHandles = {};
-        m_mapCBV.clear();
-        m_mapSRV.clear();
-        m_mapUAV.clear();
-        m_mapConstants.clear();
+        m_compute.reset(nullptr);
+        m_graphics.reset(nullptr);
     }
     m_base->ClearState(pPipelineState);
 }
@@ -298,20 +290,20 @@ void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetComputeRootSignature(ID3D12R
     m_base->SetComputeRootSignature(pRootSignature);
 
     // App can set the same root signature multiple times so check
-    if (m_trackState && pRootSignature != m_rootSignature)
+    if (m_trackState && pRootSignature != m_compute.rootSignature)
     {
-        m_rootSignature = pRootSignature;
-        // Clear root signature cached items
-        m_mapCBV.clear();
-        m_mapSRV.clear();
-        m_mapUAV.clear();
-        m_mapConstants.clear();
-        m_mapHandles.clear();
+        // Root arguments do not survive root signature change
+        m_compute.reset(pRootSignature);
     }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetGraphicsRootSignature(ID3D12RootSignature* pRootSignature)
 {
     m_base->SetGraphicsRootSignature(pRootSignature);
+
+    if (m_trackState && pRootSignature != m_graphics.rootSignature)
+    {
+        m_graphics.reset(pRootSignature);
+    }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetComputeRootDescriptorTable(UINT RootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor)
 {
@@ -319,48 +311,60 @@ void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetComputeRootDescriptorTable(U
 
     if (m_trackState)
     {
-        m_mapHandles[RootParameterIndex] = BaseDescriptor;
+        m_compute.setArg(RootParameterIndex, RootState::ArgType::eTable, BaseDescriptor.ptr);
     }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetGraphicsRootDescriptorTable(UINT RootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor)
 {
     m_base->SetGraphicsRootDescriptorTable(RootParameterIndex, BaseDescriptor);
+
+    if (m_trackState)
+    {
+        m_graphics.setArg(RootParameterIndex, RootState::ArgType::eTable, BaseDescriptor.ptr);
+    }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetComputeRoot32BitConstant(UINT RootParameterIndex, UINT SrcData, UINT DestOffsetIn32BitValues)
 {
     m_base->SetComputeRoot32BitConstant(RootParameterIndex, SrcData, DestOffsetIn32BitValues);
 
-    if (m_trackState)
+    if (m_trackState && !m_compute.setConstants(RootParameterIndex, 1, &SrcData, DestOffsetIn32BitValues))
     {
-        auto& entry = m_mapConstants[RootParameterIndex];
-        entry.Num32BitValuesToSet = 1;
-        entry.SrcData[0] = SrcData;
+        SL_LOG_WARN("Invalid root constant %u at offset %u", RootParameterIndex, DestOffsetIn32BitValues);
     }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetGraphicsRoot32BitConstant(UINT RootParameterIndex, UINT SrcData, UINT DestOffsetIn32BitValues)
 {
     m_base->SetGraphicsRoot32BitConstant(RootParameterIndex, SrcData, DestOffsetIn32BitValues);
+
+    if (m_trackState && !m_graphics.setConstants(RootParameterIndex, 1, &SrcData, DestOffsetIn32BitValues))
+    {
+        SL_LOG_WARN("Invalid root constant %u at offset %u", RootParameterIndex, DestOffsetIn32BitValues);
+    }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetComputeRoot32BitConstants(UINT RootParameterIndex, UINT Num32BitValuesToSet, const void* pSrcData, UINT DestOffsetIn32BitValues)
 {
     m_base->SetComputeRoot32BitConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
 
-    assert(Num32BitValuesToSet <= kMaxComputeRoot32BitConstCount);
-
-    if (Num32BitValuesToSet > kMaxComputeRoot32BitConstCount)
-    {
-        SL_LOG_WARN("Too many 32bit root constants %u", Num32BitValuesToSet);
-    }
-    else if(m_trackState)
+    if (m_trackState)
     {
-        auto& entry = m_mapConstants[RootParameterIndex];
-        entry.Num32BitValuesToSet = Num32BitValuesToSet;
-        memcpy(entry.SrcData, pSrcData, sizeof(uint32_t) * Num32BitValuesToSet);
+        if (Num32BitValuesToSet > kMaxComputeRoot32BitConstCount || DestOffsetIn32BitValues > kMaxComputeRoot32BitConstCount - Num32BitValuesToSet)
+        {
+            SL_LOG_WARN("Too many 32bit root constants %u at offset %u", Num32BitValuesToSet, DestOffsetIn32BitValues);
+        }
+        else if (!m_compute.setConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues))
+        {
+            SL_LOG_WARN("Invalid root constants %u", RootParameterIndex);
+        }
     }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetGraphicsRoot32BitConstants(UINT RootParameterIndex, UINT Num32BitValuesToSet, const void* pSrcData, UINT DestOffsetIn32BitValues)
 {
     m_base->SetGraphicsRoot32BitConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
+
+    if (m_trackState && !m_graphics.setConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues))
+    {
+        SL_LOG_WARN("Too many 32bit root constants %u", Num32BitValuesToSet);
+    }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetComputeRootConstantBufferView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
 {
@@ -368,12 +372,17 @@ void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetComputeRootConstantBufferVie
 
     if (m_trackState)
     {
-        m_mapCBV[RootParameterIndex] = BufferLocation;
+        m_compute.setArg(RootParameterIndex, RootState::ArgType::eCBV, BufferLocation);
     }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetGraphicsRootConstantBufferView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
 {
     m_base->SetGraphicsRootConstantBufferView(RootParameterIndex, BufferLocation);
+
+    if (m_trackState)
+    {
+        m_graphics.setArg(RootParameterIndex, RootState::ArgType::eCBV, BufferLocation);
+    }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetComputeRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
 {
@@ -381,12 +390,17 @@ void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetComputeRootShaderResourceVie
 
     if (m_trackState)
     {
-        m_mapSRV[RootParameterIndex] = BufferLocation;
+        m_compute.setArg(RootParameterIndex, RootState::ArgType::eSRV, BufferLocation);
     }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetGraphicsRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
 {
     m_base->SetGraphicsRootShaderResourceView(RootParameterIndex, BufferLocation);
+
+    if (m_trackState)
+    {
+        m_graphics.setArg(RootParameterIndex, RootState::ArgType::eSRV, BufferLocation);
+    }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetComputeRootUnorderedAccessView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
 {
@@ -394,12 +408,17 @@ void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetComputeRootUnorderedAccessVi
 
     if (m_trackState)
     {
-        m_mapUAV[RootParameterIndex] = BufferLocation;
+        m_compute.setArg(RootParameterIndex, RootState::ArgType::eUAV, BufferLocation);
     }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::SetGraphicsRootUnorderedAccessView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation)
 {
     m_base->SetGraphicsRootUnorderedAccessView(RootParameterIndex, BufferLocation);
+
+    if (m_trackState)
+    {
+        m_graphics.setArg(RootParameterIndex, RootState::ArgType::eUAV, BufferLocation);
+    }
 }
 void STDMETHODCALLTYPE D3D12GraphicsCommandList::IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* pView)
 {
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <map>
+#include <string.h>
 #include "source/core/sl.interposer/d3d12/d3d12.h"
 
 struct D3D12Device;
@@ -34,6 +35,64 @@ namespace interposer
 
 constexpr int kMaxHeapCount = 4;
 constexpr int kMaxComputeRoot32BitConstCount = 64;
+//! Root signature is limited to 64 DWORDs so it can never have more parameters than this
+constexpr uint32_t kMaxRootParameterCount = 64;
+
+//! Root arguments set by the host for either compute or graphics pipeline
+//!
+//! Flat arrays indexed by root parameter so recording never allocates, 'setMask' has
+//! a bit for each parameter host has set since the root signature was last changed.
+struct RootState
+{
+    enum class ArgType : uint8_t
+    {
+        eTable,
+        eCBV,
+        eSRV,
+        eUAV,
+        eConstants
+    };
+
+    ID3D12RootSignature* rootSignature{};
+    uint64_t setMask{};
+    ArgType types[kMaxRootParameterCount]{};
+    //! Descriptor handle or GPU virtual address depending on the type
+    uint64_t args[kMaxRootParameterCount]{};
+    //! Root constants only, one bit per 32bit value which was set
+    uint64_t constantMasks[kMaxRootParameterCount]{};
+    uint32_t constants[kMaxRootParameterCount][kMaxComputeRoot32BitConstCount]{};
+
+    inline void reset(ID3D12RootSignature* signature)
+    {
+        rootSignature = signature;
+        setMask = 0;
+    }
+
+    inline void setArg(UINT index, ArgType type, uint64_t arg)
+    {
+        if (index >= kMaxRootParameterCount) return;
+        types[index] = type;
+        args[index] = arg;
+        setMask |= 1ull << index;
+    }
+
+    inline bool setConstants(UINT index, UINT count, const void* data, UINT offset)
+    {
+        // Written so nothing can wrap around, both values come straight from the host
+        if (index >= kMaxRootParameterCount || count > kMaxComputeRoot32BitConstCount || offset > kMaxComputeRoot32BitConstCount - count) return false;
+        if (!count) return true;
+        auto bit = 1ull << index;
+        if (!(setMask & bit) || types[index] != ArgType::eConstants)
+        {
+            types[index] = ArgType::eConstants;
+            constantMasks[index] = 0;
+            setMask |= bit;
+        }
+        memcpy(constants[index] + offset, data, sizeof(uint32_t) * count);
+        constantMasks[index] |= (count == 64 ? ~0ull : ((1ull << count) - 1)) << offset;
+        return true;
+    }
+};
 
 struct DECLSPEC_UUID("5B2662FB-EB28-4AEC-819E-1C1B4DE060F6") D3D12GraphicsCommandList : ID3D12GraphicsCommandList8
 {
@@ -161,22 +220,12 @@ struct DECLSPEC_UUID("5B2662FB-EB28-4AEC-819E-1C1B4DE060F6") D3D12GraphicsComman
     D3D12Device* const m_device{};
 
     // Used to restore states
-    struct Constants
-    {
-        uint32_t DestOffsetIn32BitValues = 0;
-        uint32_t Num32BitValuesToSet = 0;
-        uint32_t SrcData[kMaxComputeRoot32BitConstCount] = {};
-    };
     uint8_t m_numHeaps{};
-    ID3D12RootSignature* m_rootSignature{};
     ID3D12PipelineState* m_pso{};
     ID3D12StateObject* m_so{};
     ID3D12DescriptorHeap* m_heaps[kMaxHeapCount]{};
-    std::map<uint32_t, D3D12_GPU_DESCRIPTOR_HANDLE> m_mapHandles{};
-    std::map<uint32_t, D3D12_GPU_VIRTUAL_ADDRESS> m_mapCBV{};
-    std::map<uint32_t, D3D12_GPU_VIRTUAL_ADDRESS> m_mapSRV{};
-    std::map<uint32_t, D3D12_GPU_VIRTUAL_ADDRESS> m_mapUAV{};
-    std::map<uint32_t, Constants> m_mapConstants{};
+    RootState m_compute{};
+    RootState m_graphics{};
 };
 
 }
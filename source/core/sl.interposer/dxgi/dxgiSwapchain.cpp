@@ -29,6 +29,7 @@
 #include "source/core/sl.interposer/d3d12/d3d12CommandQueue.h"
 #include "source/core/sl.api/internal.h"
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.trace/trace.h"
 #include "source/core/sl.plugin-manager/pluginManager.h"
 #include "source/core/sl.exception/exception.h"
 
@@ -200,6 +201,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::Present(UINT SyncInterval, UINT Flags)
         HRESULT hr = S_OK;
         for (auto [hook, feature] : hooks)
         {
+            SL_TRACE_SCOPE_ARG("IDXGISwapChain_Present.hook", feature);
             hr = ((PFunPresentBefore*)hook)(m_base, SyncInterval, Flags, skip);
             if (FAILED(hr))
             {
@@ -381,6 +383,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::Present1(UINT SyncInterval, UINT Presen
         HRESULT hr = S_OK;
         for (auto [hook, feature] : hooks)
         {
+            SL_TRACE_SCOPE_ARG("IDXGISwapChain_Present1.hook", feature);
             hr = ((PFunPresent1Before*)hook)(m_base, SyncInterval, PresentFlags, pPresentParameters, skip);
             if (FAILED(hr))
             {
@@ -76,6 +76,7 @@ if (config.contains(#a))
                     SL_EXTRACT_CONFIG_FLAG(vkValidation);
                     SL_EXTRACT_CONFIG_FLAG(logPath);
                     SL_EXTRACT_CONFIG_FLAG(pathToPlugins);
+                    SL_EXTRACT_CONFIG_FLAG(tracePath);
                     SL_EXTRACT_CONFIG_FLAG(logLevel);
                     SL_EXTRACT_CONFIG_FLAG(logMessageDelayMs);
                     SL_EXTRACT_CONFIG_FLAG(waitForDebugger);
@@ -83,6 +84,8 @@ if (config.contains(#a))
                     SL_EXTRACT_CONFIG_FLAG(forceNonNVDA);
                     SL_EXTRACT_CONFIG_FLAG(trackEngineAllocations);
                     SL_EXTRACT_CONFIG_FLAG(enableD3D12DebugLayer);
+                    SL_EXTRACT_CONFIG_FLAG(useJSONPluginConfig);
+                    SL_EXTRACT_CONFIG_FLAG(validateFrameTokens);
 
                     if (m_config.trackEngineAllocations)
                     {
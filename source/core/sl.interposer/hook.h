@@ -80,10 +80,15 @@ struct InterposerConfig
     bool forceNonNVDA = false;
     bool trackEngineAllocations = false;
     bool enableD3D12DebugLayer = false;
+    bool useJSONPluginConfig = false;
+    //! Reports frame tokens used after they are (or are about to be) reissued for a newer frame
+    bool validateFrameTokens = false;
     float logMessageDelayMs = 5000.0f;
     uint32_t logLevel = 2;
     std::string logPath{};
     std::string pathToPlugins{};
+    //! Full path to the Chrome trace JSON written on shutdown, tracing is off if empty
+    std::string tracePath{};
     std::vector<Feature> loadSpecificFeatures{};
 };
 
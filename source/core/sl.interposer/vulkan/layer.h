@@ -23,6 +23,10 @@
 #pragma once
 
 #include <mutex>
+#include <atomic>
+#include <vector>
+#include <map>
+#include <algorithm>
 
 #include "external/vulkan/include/vulkan/vulkan.h"
 #include "external/vulkan/include/vulkan/vk_layer.h"
@@ -36,6 +40,111 @@ namespace sl
 namespace interposer
 {
 
+//! Dispatch tables keyed by the loader dispatch pointer
+//!
+//! Loader stores a pointer to its own dispatch table at the start of every dispatchable
+//! handle and all children (queues, command buffers, physical devices) share it with
+//! their parent device/instance. Keying by it means any handle can be used for lookup.
+//!
+//! Map is RCU style: readers load one atomic snapshot pointer and scan a handful of
+//! entries without any locks. Writers (device/instance creation and destruction)
+//! serialize, copy the snapshot and publish a new one. Old snapshots and tables are
+//! retired and only released when the map is destroyed since readers could still be
+//! using them; creation is rare so this costs next to nothing.
+template<typename T>
+struct DispatchMap
+{
+    DispatchMap() = default;
+    DispatchMap(const DispatchMap&) = delete;
+    DispatchMap& operator=(const DispatchMap&) = delete;
+
+    ~DispatchMap()
+    {
+        for (auto snapshot : m_retiredSnapshots) delete snapshot;
+        for (auto table : m_retiredTables) delete table;
+        auto snapshot = m_snapshot.load();
+        if (snapshot)
+        {
+            for (auto& entry : snapshot->entries) delete entry.table;
+            delete snapshot;
+        }
+    }
+
+    inline static void* getKey(const void* handle) { return handle ? *(void**)handle : nullptr; }
+
+    //! Lock-free, returns null if there is no table for the handle
+    inline const T* get(const void* handle) const
+    {
+        auto snapshot = m_snapshot.load(std::memory_order_acquire);
+        if (!snapshot) return nullptr;
+        auto key = getKey(handle);
+        for (auto& entry : snapshot->entries)
+        {
+            if (entry.key == key) return entry.table;
+        }
+        return nullptr;
+    }
+
+    void set(const void* handle, const T& table)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto key = getKey(handle);
+        auto current = m_snapshot.load(std::memory_order_relaxed);
+        auto snapshot = current ? new Snapshot(*current) : new Snapshot();
+        auto it = std::find_if(snapshot->entries.begin(), snapshot->entries.end(), [key](const Entry& e)->bool { return e.key == key; });
+        if (it != snapshot->entries.end())
+        {
+            m_retiredTables.push_back(it->table);
+            it->table = new T(table);
+        }
+        else
+        {
+            snapshot->entries.push_back({ key, new T(table) });
+        }
+        publish(current, snapshot);
+    }
+
+    void erase(const void* handle)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto key = getKey(handle);
+        auto current = m_snapshot.load(std::memory_order_relaxed);
+        if (!current) return;
+        auto snapshot = new Snapshot(*current);
+        auto it = std::find_if(snapshot->entries.begin(), snapshot->entries.end(), [key](const Entry& e)->bool { return e.key == key; });
+        if (it == snapshot->entries.end())
+        {
+            delete snapshot;
+            return;
+        }
+        m_retiredTables.push_back(it->table);
+        snapshot->entries.erase(it);
+        publish(current, snapshot);
+    }
+
+private:
+    struct Entry
+    {
+        void* key;
+        const T* table;
+    };
+    struct Snapshot
+    {
+        std::vector<Entry> entries;
+    };
+
+    void publish(Snapshot* current, Snapshot* snapshot)
+    {
+        m_snapshot.store(snapshot, std::memory_order_release);
+        if (current) m_retiredSnapshots.push_back(current);
+    }
+
+    std::atomic<Snapshot*> m_snapshot{};
+    std::mutex m_mutex;
+    std::vector<Snapshot*> m_retiredSnapshots;
+    std::vector<const T*> m_retiredTables;
+};
+
 struct VkTable
 {
     VkDevice device;
@@ -54,8 +163,8 @@ struct VkTable
     bool nativeOpticalFlowHWSupport = false;
 
     std::mutex mutex;
-    std::map<void*, VkLayerInstanceDispatchTable> dispatchInstanceMap;
-    std::map<void*, VkLayerDispatchTable> dispatchDeviceMap;
+    DispatchMap<VkLayerInstanceDispatchTable> dispatchInstanceMap;
+    DispatchMap<VkLayerDispatchTable> dispatchDeviceMap;
     std::map<VkPhysicalDevice, VkInstance> instanceDeviceMap;
 
     void mapVulkanInstanceAPI(VkInstance instance);
@@ -142,8 +251,7 @@ inline void VkTable::mapVulkanInstanceAPI(VkInstance instance)
     dt.GetPhysicalDeviceWin32PresentationSupportKHR = (PFN_vkGetPhysicalDeviceWin32PresentationSupportKHR)getInstanceProcAddr(instance, "vkGetPhysicalDeviceWin32PresentationSupportKHR");
 #endif /* defined(VK_KHR_win32_surface) */
 
-    std::lock_guard<std::mutex> lock(mutex);
-    dispatchInstanceMap[instance] = dt;
+    dispatchInstanceMap.set(instance, dt);
 }
 
 inline void VkTable::mapVulkanDeviceAPI(VkDevice device)
@@ -392,8 +500,7 @@ inline void VkTable::mapVulkanDeviceAPI(VkDevice device)
     SL_GDPR(GetDeviceImageSparseMemoryRequirements);
 #endif
 
-    std::lock_guard<std::mutex> lock(mutex);
-    dispatchDeviceMap[device] = dt;
+    dispatchDeviceMap.set(device, dt);
 }
 
 }
@@ -0,0 +1,104 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+namespace sl
+{
+
+namespace interposer
+{
+
+//! FNV-1a with a seed, usable at compile time
+constexpr uint32_t hashProcName(const char* name, uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ seed;
+    while (*name)
+    {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+//! Perfect hash table mapping intercepted Vulkan entry point names to an index
+//!
+//! Seed is searched for at compile time so that every name lands in its own slot,
+//! lookup is then one hash, one load and one string compare to reject misses.
+//!
+//! Function pointers are kept outside of the table since casting to PFN_vkVoidFunction
+//! is not allowed in constant expressions.
+template<size_t N>
+struct ProcAddrTable
+{
+    //! Plenty of empty slots so seed search terminates quickly
+    static constexpr uint32_t kSlotCount = [] { uint32_t size = 1; while (size < N * 4) size <<= 1; return size; }();
+    static constexpr uint8_t kEmpty = 0xff;
+    static_assert(N < kEmpty, "Too many entries for the proc address table");
+
+    constexpr ProcAddrTable(const char* const (&names)[N])
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            m_names[i] = names[i];
+        }
+        for (uint32_t seed = 0; seed < 0x10000; seed++)
+        {
+            for (auto& slot : m_slots) slot = kEmpty;
+            bool collision = false;
+            for (size_t i = 0; i < N && !collision; i++)
+            {
+                auto& slot = m_slots[hashProcName(names[i], seed) & (kSlotCount - 1)];
+                collision = slot != kEmpty;
+                slot = (uint8_t)i;
+            }
+            if (!collision)
+            {
+                m_seed = seed;
+                m_valid = true;
+                return;
+            }
+        }
+    }
+
+    //! Returns index of the name in the original list or -1 if we do not intercept it
+    inline int find(const char* name) const
+    {
+        auto index = m_slots[hashProcName(name, m_seed) & (kSlotCount - 1)];
+        if (index == kEmpty || strcmp(m_names[index], name) != 0) return -1;
+        return index;
+    }
+
+    constexpr bool isValid() const { return m_valid; }
+
+private:
+    const char* m_names[N]{};
+    uint8_t m_slots[kSlotCount]{};
+    uint32_t m_seed{};
+    bool m_valid{};
+};
+
+}
+}
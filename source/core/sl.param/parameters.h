@@ -40,6 +40,7 @@ constexpr const char* kPFunAllocateResource = "sl.param.global.allocateResource"
 constexpr const char* kPFunReleaseResource = "sl.param.global.releaseResource";
 constexpr const char* kPluginPath = "sl.param.global.pluginPath";
 constexpr const char* kLogInterface = "sl.param.global.logInterface";
+constexpr const char* kTraceInterface = "sl.param.global.traceInterface";
 constexpr const char* kPluginManagerInterface = "sl.param.global.pluginManagerInterface";
 constexpr const char* kOTAInterface = "sl.param.global.otaInterface";
 constexpr const char* kNGXContext = "sl.param.global.ngxContext";
@@ -0,0 +1,378 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifdef SL_WINDOWS
+// Prevent warnings from MS headers
+#define WIN32_NO_STATUS
+#include <windows.h>
+#undef WIN32_NO_STATUS
+#include <ntstatus.h>
+#include <Winternl.h>
+#include <d3dkmthk.h>
+#else
+#include <sys/utsname.h>
+#endif
+
+#include "source/core/sl.log/log.h"
+#include "source/core/sl.file/file.h"
+#include "source/core/sl.extra/extra.h"
+#include "source/core/sl.plugin-manager/pluginCache.h"
+
+namespace sl
+{
+
+namespace plugin_manager
+{
+
+//! Bump when layout of PluginMetadata changes
+constexpr uint32_t kPluginCacheMagic = 0x43504c53; // 'SLPC'
+constexpr uint32_t kPluginCacheVersion = 2;
+//! Upper bound for adapters mixed into the system identity
+constexpr uint32_t kPluginCacheMaxNumAdapters = 16;
+
+namespace
+{
+
+//! FNV-1a, only used on small buffers (identity, cache payload)
+struct Hasher
+{
+    uint64_t value = 14695981039346656037ull;
+
+    void mix(const void* data, size_t size)
+    {
+        auto p = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++)
+        {
+            value ^= p[i];
+            value *= 1099511628211ull;
+        }
+    }
+
+    template<typename T>
+    void pod(const T& v) { mix(&v, sizeof(T)); }
+};
+
+struct Writer
+{
+    std::vector<uint8_t> data;
+
+    template<typename T>
+    void pod(const T& v)
+    {
+        auto p = (const uint8_t*)&v;
+        data.insert(data.end(), p, p + sizeof(T));
+    }
+
+    template<typename C>
+    void str(const std::basic_string<C>& s)
+    {
+        pod((uint32_t)s.size());
+        auto p = (const uint8_t*)s.data();
+        data.insert(data.end(), p, p + s.size() * sizeof(C));
+    }
+
+    void strings(const std::vector<std::string>& list)
+    {
+        pod((uint32_t)list.size());
+        for (auto& s : list) str(s);
+    }
+};
+
+//! Bounds checked, any failure leaves 'ok' false and everything read after that is ignored
+struct Reader
+{
+    const uint8_t* data{};
+    size_t size{};
+    size_t offset{};
+    bool ok = true;
+
+    template<typename T>
+    void pod(T& v)
+    {
+        if (!ok || offset + sizeof(T) > size)
+        {
+            ok = false;
+            return;
+        }
+        memcpy(&v, data + offset, sizeof(T));
+        offset += sizeof(T);
+    }
+
+    template<typename C>
+    void str(std::basic_string<C>& s)
+    {
+        uint32_t n{};
+        pod(n);
+        if (!ok || offset + size_t(n) * sizeof(C) > size)
+        {
+            ok = false;
+            return;
+        }
+        s.assign((const C*)(data + offset), n);
+        offset += size_t(n) * sizeof(C);
+    }
+
+    void strings(std::vector<std::string>& list)
+    {
+        uint32_t n{};
+        pod(n);
+        // Each string takes at least its length
+        if (!ok || size_t(n) * sizeof(uint32_t) > size - offset)
+        {
+            ok = false;
+            return;
+        }
+        list.resize(n);
+        for (auto& s : list) str(s);
+    }
+};
+
+}
+
+bool PluginMetadataCache::getModuleKey(const std::wstring& path, PluginModuleKey& key)
+{
+    std::error_code ec;
+    key.path = path;
+    key.size = fs::file_size(path, ec);
+    if (ec) return false;
+    key.modTime = fs::last_write_time(path, ec).time_since_epoch().count();
+    return !ec;
+}
+
+uint64_t PluginMetadataCache::getSystemIdentity()
+{
+    Hasher h{};
+#ifdef SL_WINDOWS
+    using PFunRtlGetVersion = NTSTATUS(WINAPI*)(PRTL_OSVERSIONINFOW);
+    auto rtlGetVersion = reinterpret_cast<PFunRtlGetVersion>(GetProcAddress(GetModuleHandleW(L"ntdll"), "RtlGetVersion"));
+    RTL_OSVERSIONINFOW osVer{};
+    osVer.dwOSVersionInfoSize = sizeof(osVer);
+    if (rtlGetVersion && NT_SUCCESS(rtlGetVersion(&osVer)))
+    {
+        h.pod(osVer.dwMajorVersion);
+        h.pod(osVer.dwMinorVersion);
+        h.pod(osVer.dwBuildNumber);
+    }
+
+    // Going through KMT avoids creating a DXGI factory while our own proxies are being set up
+    auto modGDI32 = LoadLibraryExW(L"gdi32.dll", NULL, LOAD_LIBRARY_SEARCH_SYSTEM32);
+    if (!modGDI32) return h.value;
+    auto pfnEnumAdapters2 = (PFND3DKMT_ENUMADAPTERS2)GetProcAddress(modGDI32, "D3DKMTEnumAdapters2");
+    auto pfnQueryAdapterInfo = (PFND3DKMT_QUERYADAPTERINFO)GetProcAddress(modGDI32, "D3DKMTQueryAdapterInfo");
+    auto pfnCloseAdapter = (PFND3DKMT_CLOSEADAPTER)GetProcAddress(modGDI32, "D3DKMTCloseAdapter");
+    if (pfnEnumAdapters2 && pfnQueryAdapterInfo)
+    {
+        D3DKMT_ADAPTERINFO adapterInfo[kPluginCacheMaxNumAdapters]{};
+        D3DKMT_ENUMADAPTERS2 enumAdapters2{};
+        enumAdapters2.NumAdapters = kPluginCacheMaxNumAdapters;
+        enumAdapters2.pAdapters = adapterInfo;
+        auto status = pfnEnumAdapters2(&enumAdapters2);
+        h.pod(status);
+        for (uint32_t i = 0; NT_SUCCESS(status) && i < enumAdapters2.NumAdapters; i++)
+        {
+            h.pod(adapterInfo[i].AdapterLuid);
+
+            D3DKMT_QUERYADAPTERINFO query{};
+            query.hAdapter = adapterInfo[i].hAdapter;
+
+            D3DKMT_UMD_DRIVER_VERSION driver{};
+            query.Type = KMTQAITYPE_UMD_DRIVER_VERSION;
+            query.pPrivateDriverData = &driver;
+            query.PrivateDriverDataSize = sizeof(driver);
+            if (NT_SUCCESS(pfnQueryAdapterInfo(&query)))
+            {
+                h.pod(driver.DriverVersion);
+            }
+
+            D3DKMT_WDDM_2_7_CAPS caps{};
+            query.Type = KMTQAITYPE_WDDM_2_7_CAPS;
+            query.pPrivateDriverData = &caps;
+            query.PrivateDriverDataSize = sizeof(caps);
+            if (NT_SUCCESS(pfnQueryAdapterInfo(&query)))
+            {
+                h.pod(caps.Value);
+            }
+
+            if (pfnCloseAdapter)
+            {
+                D3DKMT_CLOSEADAPTER closeAdapter{ adapterInfo[i].hAdapter };
+                pfnCloseAdapter(&closeAdapter);
+            }
+        }
+    }
+    FreeLibrary(modGDI32);
+#else
+    utsname info{};
+    if (uname(&info) == 0)
+    {
+        h.mix(info.release, strnlen(info.release, sizeof(info.release)));
+        h.mix(info.version, strnlen(info.version, sizeof(info.version)));
+        h.mix(info.machine, strnlen(info.machine, sizeof(info.machine)));
+    }
+#endif
+    return h.value;
+}
+
+std::wstring PluginMetadataCache::getCacheFile(int appId)
+{
+    // One file per application and executable, hosts sharing the temp folder never overwrite each other's metadata
+    auto exeName = fs::path(file::getExecutableName()).filename().wstring();
+    auto exeHash = std::hash<std::wstring>{}(file::getExecutablePath() + exeName);
+    auto directory = fs::path(file::getTmpPath()) / L"sl.plugin.cache";
+    file::createDirectoryRecursively(directory.wstring().c_str());
+    auto name = exeName + L"." + std::to_wstring(appId) + L"." + extra::toWStr(extra::toHexStr(exeHash)) + L".bin";
+    return (directory / name).wstring();
+}
+
+void PluginMetadataCache::load(const std::wstring& cacheFile, uint64_t environment)
+{
+    m_entries.clear();
+    m_environment = environment;
+    m_dirty = false;
+
+    if (!file::exists(cacheFile.c_str())) return;
+
+    auto data = file::read(cacheFile.c_str());
+    Reader r{ data.data(), data.size() };
+    uint32_t magic{}, version{}, count{};
+    uint64_t cachedEnvironment{}, payloadHash{};
+    r.pod(magic);
+    r.pod(version);
+    r.pod(cachedEnvironment);
+    r.pod(payloadHash);
+    r.pod(count);
+    if (!r.ok || magic != kPluginCacheMagic || version != kPluginCacheVersion || cachedEnvironment != environment)
+    {
+        SL_LOG_WARN("Plugin metadata cache '%S' is invalid or outdated - ignoring", cacheFile.c_str());
+        return;
+    }
+    Hasher h{};
+    h.mix(data.data() + r.offset, data.size() - r.offset);
+    if (h.value != payloadHash)
+    {
+        SL_LOG_WARN("Plugin metadata cache '%S' is corrupted - ignoring", cacheFile.c_str());
+        return;
+    }
+    for (uint32_t i = 0; i < count && r.ok; i++)
+    {
+        PluginMetadata m{};
+        r.str(m.key.path);
+        r.pod(m.key.size);
+        r.pod(m.key.modTime);
+        r.pod(m.id);
+        r.pod(m.priority);
+        r.pod(m.supportedAdapters);
+        r.str(m.name);
+        r.strings(m.requiredPlugins);
+        r.strings(m.exclusiveHooks);
+        r.strings(m.incompatiblePlugins);
+        r.str(m.hooks);
+        r.str(m.externalConfig);
+        if (!r.ok) break;
+
+        // Entry has to describe the module it is keyed by, plugin names always match their module names
+        auto path = fs::path(m.key.path);
+        if (!path.is_absolute() || path.stem().string() != m.name || m.name.rfind("sl.", 0) != 0)
+        {
+            SL_LOG_WARN("Plugin metadata cache entry '%S' does not match its module - ignoring", m.key.path.c_str());
+            m_dirty = true;
+            continue;
+        }
+        m_entries[m.key.path] = std::move(m);
+    }
+    if (!r.ok || r.offset != data.size())
+    {
+        SL_LOG_WARN("Plugin metadata cache '%S' is truncated - ignoring", cacheFile.c_str());
+        m_entries.clear();
+        return;
+    }
+    SL_LOG_VERBOSE("Loaded metadata for %llu plugin(s) from '%S'", m_entries.size(), cacheFile.c_str());
+}
+
+void PluginMetadataCache::save(const std::wstring& cacheFile)
+{
+    if (!m_dirty) return;
+
+    Writer payload{};
+    for (auto& [path, m] : m_entries)
+    {
+        payload.str(m.key.path);
+        payload.pod(m.key.size);
+        payload.pod(m.key.modTime);
+        payload.pod(m.id);
+        payload.pod(m.priority);
+        payload.pod(m.supportedAdapters);
+        payload.str(m.name);
+        payload.strings(m.requiredPlugins);
+        payload.strings(m.exclusiveHooks);
+        payload.strings(m.incompatiblePlugins);
+        payload.str(m.hooks);
+        payload.str(m.externalConfig);
+    }
+    Hasher h{};
+    h.mix(payload.data.data(), payload.data.size());
+
+    Writer w{};
+    w.pod(kPluginCacheMagic);
+    w.pod(kPluginCacheVersion);
+    w.pod(m_environment);
+    w.pod(h.value);
+    w.pod((uint32_t)m_entries.size());
+    w.data.insert(w.data.end(), payload.data.begin(), payload.data.end());
+
+    // Write to a temporary file first so concurrent processes never see partial data
+    auto tmpFile = cacheFile + L".tmp";
+    file::write(tmpFile.c_str(), w.data);
+    std::error_code ec;
+    fs::rename(tmpFile, cacheFile, ec);
+    if (ec)
+    {
+        SL_LOG_WARN("Failed to write plugin metadata cache '%S' - %s", cacheFile.c_str(), ec.message().c_str());
+        fs::remove(tmpFile, ec);
+        return;
+    }
+    m_dirty = false;
+}
+
+const PluginMetadata* PluginMetadataCache::find(const PluginModuleKey& key) const
+{
+    auto it = m_entries.find(key.path);
+    if (it == m_entries.end() || !((*it).second.key == key))
+    {
+        return nullptr;
+    }
+    return &(*it).second;
+}
+
+void PluginMetadataCache::store(const PluginMetadata& metadata)
+{
+    m_entries[metadata.key.path] = metadata;
+    m_dirty = true;
+}
+
+void PluginMetadataCache::invalidate(const std::wstring& path)
+{
+    m_dirty |= m_entries.erase(path) > 0;
+}
+
+}
+}
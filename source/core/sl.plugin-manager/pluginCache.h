@@ -0,0 +1,109 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace sl
+{
+
+namespace plugin_manager
+{
+
+//! Identifies exact module on disk, any change invalidates cached metadata
+//!
+//! Size and write time are enough here, cache is only ever used to skip modules
+//! and anything which is actually loaded still goes through the signature check.
+struct PluginModuleKey
+{
+    std::wstring path{};
+    uint64_t size{};
+    int64_t modTime{};
+
+    inline bool operator==(const PluginModuleKey& rhs) const
+    {
+        return path == rhs.path && size == rhs.size && modTime == rhs.modTime;
+    }
+};
+
+//! Everything we learn from a plugin after 'slOnPluginLoad' which does not depend on the device
+struct PluginMetadata
+{
+    PluginModuleKey key{};
+    uint32_t id{};
+    int priority{};
+    uint32_t supportedAdapters{};
+    std::string name{};
+    std::vector<std::string> requiredPlugins{};
+    std::vector<std::string> exclusiveHooks{};
+    std::vector<std::string> incompatiblePlugins{};
+    //! Serialized JSON, only parsed when plugin is actually needed
+    std::string hooks{};
+    std::string externalConfig{};
+};
+
+//! Persistent binary cache of plugin metadata
+//!
+//! Allows plugin manager to skip loading (and verifying signatures of) modules
+//! which were not requested by the host, without loading them just to find out their id.
+//!
+//! NOT thread safe
+class PluginMetadataCache
+{
+public:
+    //! Computes module key, returns false if file cannot be accessed
+    static bool getModuleKey(const std::wstring& path, PluginModuleKey& key);
+
+    //! Hash of the adapters (LUID, driver version, scheduling caps) and OS version
+    //!
+    //! Plugins check all of these in 'slOnPluginLoad' so cached adapter masks
+    //! and external configs are only valid on the exact same system.
+    static uint64_t getSystemIdentity();
+
+    //! Cache file for the given application and host executable, creates the directory if needed
+    static std::wstring getCacheFile(int appId);
+
+    //! Missing or corrupted file simply results in an empty cache, invalid entries are dropped
+    //!
+    //! Environment is a hash of everything plugins see on load (host version, preferences,
+    //! system identity etc.), cache written with a different environment is discarded.
+    void load(const std::wstring& cacheFile, uint64_t environment);
+    //! Writes cache only if something changed since load
+    void save(const std::wstring& cacheFile);
+
+    //! Returns null if module is not cached or it changed on disk
+    const PluginMetadata* find(const PluginModuleKey& key) const;
+    void store(const PluginMetadata& metadata);
+    //! Drops entry which turned out to be wrong, it is refreshed next time the module is loaded
+    void invalidate(const std::wstring& path);
+
+private:
+    std::map<std::wstring, PluginMetadata> m_entries{};
+    uint64_t m_environment{};
+    bool m_dirty = false;
+};
+
+}
+}
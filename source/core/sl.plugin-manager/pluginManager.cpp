@@ -31,15 +31,24 @@
 
 #include <sstream>
 #include <random>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <functional>
+#include <memory>
+#include <atomic>
 
 #include "include/sl_hooks.h"
 #include "include/sl_version.h"
 #include "source/core/sl.api/internal.h"
+#include "source/core/sl.api/loaderConfig.h"
 #include "source/core/sl.log/log.h"
 #include "source/core/sl.file/file.h"
 #include "source/core/sl.param/parameters.h"
 #include "source/core/sl.plugin-manager/ota.h"
 #include "source/core/sl.plugin-manager/pluginManager.h"
+#include "source/core/sl.plugin-manager/pluginCache.h"
 #include "source/core/sl.security/secureLoadLibrary.h"
 #include "source/core/sl.interposer/versions.h"
 #include "source/core/sl.interposer/hook.h"
@@ -254,6 +263,7 @@ public:
     }
 
     void populateLoaderJSON(uint32_t deviceType, json& config);
+    void populateLoaderConfig(uint32_t deviceType, std::vector<uint8_t>& config, std::string& configJSON);
 
     std::mutex m_mtxPluginConfig;
 
@@ -286,16 +296,19 @@ private:
         api::PFuncOnPluginShutdown* onShutdown{};
         api::PFuncGetPluginFunction* getFunction{};
         api::PFuncOnPluginLoad* onLoad{};
+        api::PFuncOnPluginSetLoaderConfig* setLoaderConfig{};
         std::vector<std::string> requiredPlugins;
         std::vector<std::string> exclusiveHooks;
         std::vector<std::string> incompatiblePlugins;
         FeatureContext context{};
     };
 
-    bool loadPlugin(const fs::path path, Plugin **ppPlugin);
+    bool loadPlugin(const fs::path path, Plugin **ppPlugin, HMODULE preloadedLib = {});
     void processPluginHooks(const Plugin* plugin);
     void mapPluginCallbacks(Plugin* plugin);
     uint32_t getFunctionHookID(const std::string& name);
+    //! Returns loader JSON text for 'slOnPluginLoad'/'slOnPluginStartup', empty if binary config was accepted
+    const char* setLoaderConfig(Plugin* plugin, const std::vector<uint8_t>& config, const std::string& configJSON);
 
     Plugin* isPluginLoaded(const std::string& name) const;
     Plugin* isExclusiveHookUsed(const Plugin* exclusivePlugin, const std::string& exclusiveHook) const;
@@ -305,8 +318,24 @@ private:
     Version m_version = { 0,0,1 };
     Version m_api = { 0,0,1 };
 
-    HookList m_beforeHooks[(uint32_t)FunctionHookID::eMaxNum];
-    HookList m_afterHooks[(uint32_t)FunctionHookID::eMaxNum];
+    //! Hooks are collected here and then published as an immutable table
+    std::vector<HookPair> m_beforeHooks[(uint32_t)FunctionHookID::eMaxNum];
+    std::vector<HookPair> m_afterHooks[(uint32_t)FunctionHookID::eMaxNum];
+
+    struct HookTable
+    {
+        HookList before[(uint32_t)FunctionHookID::eMaxNum];
+        HookList after[(uint32_t)FunctionHookID::eMaxNum];
+    };
+
+    //! Null until plugins are initialized, this is the only check on the hot path
+    std::atomic<const HookTable*> m_hookTable{};
+    //! Readers can still hold a reference to an older table so these are released only on exit
+    std::vector<std::unique_ptr<HookTable>> m_hookTables{};
+    inline static const HookList s_noHooks{};
+
+    void publishHooks();
+    const HookList& getHooksSlow(FunctionHookID functionHookID, bool before);
 
     ID3D12Device* m_d3d12Device = {};
     ID3D11Device* m_d3d11Device = {};
@@ -334,6 +363,9 @@ private:
     std::wstring m_pluginPath{};
     std::vector<std::wstring> m_pathsToPlugins{};
     std::vector<Feature> m_featuresToLoad{};
+    //! Passed to 'slOnPluginSetLoaderConfig' or as text to 'slOnPluginLoad', same for all plugins so built once
+    std::vector<uint8_t> m_loaderConfig{};
+    std::string m_loaderJSON{};
     std::map<Feature, std::string*> m_externalJSONConfigs{};
 
     Preferences m_pref{};
@@ -451,6 +483,7 @@ Result PluginManager::setFeatureEnabled(Feature feature, bool value)
         {
             processPluginHooks(plugin);
         }
+        publishHooks();
     }
     return Result::eOk;
 }
@@ -485,7 +518,7 @@ Result PluginManager::findPlugins(const std::wstring& directory, std::vector<std
     return files.empty() ? Result::eErrorNoPlugins : Result::eOk;
 }
 
-bool PluginManager::loadPlugin(const fs::path pluginFullPath, Plugin **ppPlugin)
+bool PluginManager::loadPlugin(const fs::path pluginFullPath, Plugin **ppPlugin, HMODULE preloadedLib)
 {
     auto freePlugin = [](Plugin** plugin)->void
     {
@@ -494,7 +527,8 @@ bool PluginManager::loadPlugin(const fs::path pluginFullPath, Plugin **ppPlugin)
         *plugin = nullptr;
     };
 
-    HMODULE mod = security::loadLibrary(pluginFullPath.c_str());
+    // Module could have been already loaded and verified in parallel with other plugins
+    HMODULE mod = preloadedLib ? preloadedLib : security::loadLibrary(pluginFullPath.c_str());
     if (!mod)
     {
         return false;
@@ -508,6 +542,7 @@ bool PluginManager::loadPlugin(const fs::path pluginFullPath, Plugin **ppPlugin)
     if (plugin->getFunction)
     {
         plugin->onLoad = reinterpret_cast<api::PFuncOnPluginLoad*>(plugin->getFunction("slOnPluginLoad"));
+        plugin->setLoaderConfig = reinterpret_cast<api::PFuncOnPluginSetLoaderConfig*>(plugin->getFunction("slOnPluginSetLoaderConfig"));
     }
     if (!plugin->getFunction || !plugin->onLoad)
     {
@@ -523,13 +558,8 @@ bool PluginManager::loadPlugin(const fs::path pluginFullPath, Plugin **ppPlugin)
     try
     {
         // Let's get JSON config from our plugin
-
-        json loaderJSON;
-        // Here we do not know device type yet so just pass invalid id
-        populateLoaderJSON((uint32_t)m_pref.renderAPI, loaderJSON);
-        auto loaderJSONStr = loaderJSON.dump();
         const char* pluginJSONText{};
-        if (!plugin->onLoad(parameters, loaderJSONStr.c_str(), &pluginJSONText))
+        if (!plugin->onLoad(parameters, setLoaderConfig(plugin, m_loaderConfig, m_loaderJSON), &pluginJSONText))
         {
             SL_LOG_ERROR( "Ignoring '%s' since core API 'onPluginLoad' failed", plugin->filename.c_str());
             freePlugin(&plugin);
@@ -595,14 +625,139 @@ Result PluginManager::mapPlugins(std::vector<std::wstring>& files)
         *plugin = nullptr;
     };
 
-    for (auto fileName : files)
+    // Runs 'func' for each index on a bounded number of worker threads
+    auto parallelFor = [](size_t count, const std::function<void(size_t)>& func)->void
     {
+        std::atomic<size_t> next = 0;
+        auto workerCount = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::future<void>> workers;
+        for (size_t i = 0; i < workerCount; i++)
+        {
+            workers.push_back(std::async(std::launch::async, [&next, count, &func]()->void
+            {
+                for (auto index = next++; index < count; index = next++)
+                {
+                    func(index);
+                }
+            }));
+        }
+        for (auto& worker : workers)
+        {
+            worker.wait();
+        }
+    };
+
+    // Here we do not know device type yet so just pass the one from preferences
+    populateLoaderConfig((uint32_t)m_pref.renderAPI, m_loaderConfig, m_loaderJSON);
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Everything plugins see in 'slOnPluginLoad', if any of it changes cached metadata is stale
+    auto cacheFile = PluginMetadataCache::getCacheFile(m_appId);
+    auto environment = std::hash<std::string_view>{}(std::string_view((const char*)m_loaderConfig.data(), m_loaderConfig.size()));
+    environment ^= PluginMetadataCache::getSystemIdentity() * 0x9e3779b97f4a7c15ull;
+    PluginMetadataCache cache;
+    cache.load(cacheFile, environment);
+
+    struct PluginModule
+    {
+        PluginModuleKey key{};
+        bool hasKey{};
+        //! Cached and not requested by the host, module is never loaded
+        bool skip{};
+        const PluginMetadata* metadata{};
+        HMODULE lib{};
+    };
+    std::vector<PluginModule> modules(files.size());
+
+    // Modules named after a requested feature are always loaded, cached ids are never the only thing deciding that
+    auto isRequestedModule = [this](const std::wstring& fileName)->bool
+    {
+        auto stem = fs::path(fileName).stem().string();
+        for (auto f : m_featuresToLoad)
+        {
+            if (stem == std::string("sl.") + getFeatureFilenameAsStrNoSL(f)) return true;
+        }
+        return false;
+    };
+
+    // Verifying module signatures is what dominates here so it is done in parallel,
+    // 'slOnPluginLoad' is still invoked serially and in order since plugins can modify global state.
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        auto& module = modules[i];
+        module.hasKey = PluginMetadataCache::getModuleKey(files[i], module.key);
+        module.metadata = module.hasKey ? cache.find(module.key) : nullptr;
+        module.skip = module.metadata && !isRequestedModule(files[i]) &&
+            std::find(m_featuresToLoad.begin(), m_featuresToLoad.end(), (Feature)module.metadata->id) == m_featuresToLoad.end();
+    }
+    parallelFor(files.size(), [&files, &modules](size_t i)->void
+    {
+        if (!modules[i].skip)
+        {
+            modules[i].lib = security::loadLibrary(files[i].c_str());
+        }
+    });
+
+    auto mapModule = [&](size_t i)->void
+    {
+        auto& fileName = files[i];
+        auto& module = modules[i];
+
+        if (module.skip)
+        {
+            // Host can still query external config for features it did not request
+            try
+            {
+                auto& extCfg = m_featureExternalConfigMap[(Feature)module.metadata->id];
+                extCfg = json::parse(module.metadata->externalConfig);
+                extCfg["feature"]["requested"] = false;
+            }
+            catch (std::exception& e)
+            {
+                SL_LOG_ERROR("JSON exception %s in cached metadata for plugin %s", e.what(), module.metadata->name.c_str());
+            }
+            SL_LOG_WARN("Ignoring plugin '%s' since it is was not requested by the host", module.metadata->name.c_str());
+            return;
+        }
+
         // From this point any error is fatal since user requested specific set of features
         Plugin *plugin = nullptr;
         fs::path pluginFullPath(fileName);
-        if (loadPlugin(pluginFullPath, &plugin))
+        if (module.lib && loadPlugin(pluginFullPath, &plugin, module.lib))
         {
             auto& extCfg = m_featureExternalConfigMap[plugin->id];
+
+            if (module.hasKey && !module.metadata)
+            {
+                // New or modified module, remember everything we need to skip it next time
+                try
+                {
+                    auto getItems = [plugin](const char* key, std::vector<std::string>& stringList)->void
+                    {
+                        if (plugin->config.contains(key))
+                        {
+                            plugin->config.at(key).get_to(stringList);
+                        }
+                    };
+                    PluginMetadata metadata{};
+                    metadata.key = module.key;
+                    metadata.id = plugin->id;
+                    metadata.priority = plugin->priority;
+                    metadata.supportedAdapters = plugin->context.supportedAdapters;
+                    metadata.name = plugin->name;
+                    getItems("required_plugins", metadata.requiredPlugins);
+                    getItems("exclusive_hooks", metadata.exclusiveHooks);
+                    getItems("incompatible_plugins", metadata.incompatiblePlugins);
+                    metadata.hooks = plugin->config.at("hooks").dump();
+                    metadata.externalConfig = extCfg.dump();
+                    cache.store(metadata);
+                }
+                catch (std::exception& e)
+                {
+                    SL_LOG_WARN("JSON exception %s while caching metadata for plugin %s", e.what(), plugin->name.c_str());
+                }
+            }
             Plugin *duplicatedPluginById = nullptr;
             for (auto p : m_plugins)
             {
@@ -770,6 +925,32 @@ Result PluginManager::mapPlugins(std::vector<std::wstring>& files)
         }
     };
 
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        mapModule(i);
+    }
+
+    // Skipped modules are never named after a requested feature and their cached id is never a requested one,
+    // so none of them could supply a feature which is still missing. Loading them again would only defeat the cache
+    // on every launch for hosts asking for a feature which is simply not installed.
+    uint32_t numSkipped = 0;
+    for (auto& module : modules)
+    {
+        numSkipped += module.skip ? 1 : 0;
+    }
+    for (auto f : m_featuresToLoad)
+    {
+        if (std::find_if(m_plugins.begin(), m_plugins.end(), [f](const Plugin* p)->bool { return p->id == f; }) == m_plugins.end())
+        {
+            SL_LOG_WARN("Requested feature '%s' was not found in any plugin module", getFeatureAsStr(f));
+        }
+    }
+
+    cache.save(cacheFile);
+
+    auto elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    SL_LOG_INFO("Mapped %llu plugin module(s) in %.2fms - %u skipped using cached metadata", (uint64_t)files.size(), elapsedMs, numSkipped);
+
     return m_plugins.empty() ? Result::eErrorNoPlugins : Result::eOk;
 }
 
@@ -808,6 +989,9 @@ Result PluginManager::loadPlugins()
 
     s_status = PluginManagerStatus::ePluginsLoaded;
 
+    // Hooks go back to the slow path which lazily initializes plugins
+    m_hookTable.store(nullptr, std::memory_order_release);
+
     // Kickoff OTA update, this function internally will check OTA preferences
     // !! MT Version Streamline Current Not Support OTA
     //m_ota->readServerManifest();
@@ -1030,6 +1214,7 @@ void PluginManager::unloadPlugins()
     {
         hooks.clear();
     }
+    publishHooks();
     for (auto& [feature, str] : m_externalJSONConfigs)
     {
         delete str;
@@ -1144,6 +1329,47 @@ void PluginManager::populateLoaderJSON(uint32_t deviceType, json& config)
     };
 }
 
+void PluginManager::populateLoaderConfig(uint32_t deviceType, std::vector<uint8_t>& config, std::string& configJSON)
+{
+    // Plugins which do not export 'slOnPluginSetLoaderConfig' parse this text as before
+    json loaderJSON;
+    populateLoaderJSON(deviceType, loaderJSON);
+    configJSON = loaderJSON.dump();
+
+    api::LoaderConfigHeader header{};
+    header.deviceType = deviceType;
+    header.host = m_hostSDKVersion;
+    header.pluginManager = m_version;
+    header.api = m_api;
+    header.appId = m_appId;
+    header.engineType = (uint32_t)m_engine;
+    header.preferenceFlags = (uint64_t)m_pref.flags;
+    header.interposerEnabled = sl::interposer::getInterface()->isEnabled();
+    header.forceNonNVDA = sl::interposer::getInterface()->getConfig().forceNonNVDA;
+
+    std::vector<std::string> paths;
+    for (auto& path : m_pathsToPlugins)
+    {
+        paths.push_back(extra::utf16ToUtf8(path.c_str()));
+    }
+    api::writeLoaderConfig(header, m_engineVersion, m_projectId, paths, config);
+}
+
+const char* PluginManager::setLoaderConfig(Plugin* plugin, const std::vector<uint8_t>& config, const std::string& configJSON)
+{
+    bool useJSON = !plugin->setLoaderConfig;
+#ifndef SL_PRODUCTION
+    // Debug path, each plugin has to parse the text again
+    useJSON |= sl::interposer::getInterface()->getConfig().useJSONPluginConfig;
+#endif
+    if (!useJSON && plugin->setLoaderConfig(config.data(), config.size()))
+    {
+        // Plugin already has everything, empty text tells it not to look for JSON
+        return "";
+    }
+    return configJSON.c_str();
+}
+
 Result PluginManager::initializePlugins()
 {
     if (s_status == PluginManagerStatus::ePluginsLoaded)
@@ -1179,9 +1405,9 @@ Result PluginManager::initializePlugins()
         }
 
         // We have correct device type so generate new config
-        json config;
-        populateLoaderJSON(deviceType, config);
-        const auto configStr = config.dump(); // serialize to std::string
+        std::vector<uint8_t> config;
+        std::string configJSON;
+        populateLoaderConfig(deviceType, config, configJSON);
 
         SL_LOG_INFO("Initializing plugins - api %u.%u.%u - application ID %u", m_api.major, m_api.minor, m_api.build, m_appId);
 
@@ -1201,7 +1427,7 @@ Result PluginManager::initializePlugins()
                 SL_LOG_ERROR( "onStartup/onShutdown missing for plugin %s", plugin->name.c_str());
                 extCfg["feature"]["lastError"] = "Error: core API not found in the plugin";
             }
-            else if (!plugin->onStartup(configStr.c_str(), device))
+            else if (!plugin->onStartup(setLoaderConfig(plugin, config, configJSON), device))
             {
                 unload = true;
                 extCfg["feature"]["lastError"] = "Error: onStartup failed";
@@ -1244,6 +1470,7 @@ Result PluginManager::initializePlugins()
             ui->registerRenderCallbacks(renderUI, nullptr);
         }
 
+        publishHooks();
         s_status = PluginManagerStatus::ePluginsInitialized;
     }
     else if (s_status == PluginManagerStatus::ePluginsInitialized)
@@ -1280,21 +1507,28 @@ void PluginManager::mapPluginCallbacks(Plugin* plugin)
     SL_LOG_INFO("Callback %s:slSetConsts:0x%llx", plugin->name.c_str(), plugin->context.setConstants);
 }
 
-const HookList& PluginManager::getBeforeHooks(FunctionHookID functionHookID)
+void PluginManager::publishHooks()
 {
-    // Lazy plugin initialization because of the late device initialization
-    if (s_status == PluginManagerStatus::ePluginsLoaded)
+    auto table = std::make_unique<HookTable>();
+    auto copyHooks = [](const std::vector<HookPair>& src, HookList& dst)->void
     {
-        initializePlugins();
-    }
-    else if(s_status == PluginManagerStatus::eUnknown)
+        if (src.size() > kMaxHooksPerFunction)
+        {
+            SL_LOG_ERROR("Too many hooks (%llu) for a single function, ignoring hooks past %u", src.size(), kMaxHooksPerFunction);
+        }
+        dst.count = std::min((uint32_t)src.size(), kMaxHooksPerFunction);
+        std::copy(src.begin(), src.begin() + dst.count, dst.hooks);
+    };
+    for (uint32_t i = 0; i < (uint32_t)FunctionHookID::eMaxNum; i++)
     {
-        SL_LOG_ERROR( "Please make sure to call slInit before calling DXGI/D3D/Vulkan API");
+        copyHooks(m_beforeHooks[i], table->before[i]);
+        copyHooks(m_afterHooks[i], table->after[i]);
     }
-    return m_beforeHooks[(uint32_t)functionHookID];
+    m_hookTable.store(table.get(), std::memory_order_release);
+    m_hookTables.push_back(std::move(table));
 }
 
-const HookList& PluginManager::getAfterHooks(FunctionHookID functionHookID)
+const HookList& PluginManager::getHooksSlow(FunctionHookID functionHookID, bool before)
 {
     // Lazy plugin initialization because of the late device initialization
     if (s_status == PluginManagerStatus::ePluginsLoaded)
@@ -1305,17 +1539,35 @@ const HookList& PluginManager::getAfterHooks(FunctionHookID functionHookID)
     {
         SL_LOG_ERROR( "Please make sure to call slInit before calling DXGI/D3D/Vulkan API");
     }
-    return m_afterHooks[(uint32_t)functionHookID];
+    auto table = m_hookTable.load(std::memory_order_acquire);
+    if (!table) return s_noHooks;
+    return before ? table->before[(uint32_t)functionHookID] : table->after[(uint32_t)functionHookID];
+}
+
+const HookList& PluginManager::getBeforeHooks(FunctionHookID functionHookID)
+{
+    auto table = m_hookTable.load(std::memory_order_acquire);
+    if (table) return table->before[(uint32_t)functionHookID];
+    return getHooksSlow(functionHookID, true);
+}
+
+const HookList& PluginManager::getAfterHooks(FunctionHookID functionHookID)
+{
+    auto table = m_hookTable.load(std::memory_order_acquire);
+    if (table) return table->after[(uint32_t)functionHookID];
+    return getHooksSlow(functionHookID, false);
 }
 
 const HookList& PluginManager::getBeforeHooksWithoutLazyInit(FunctionHookID functionHookID)
 {
-    return m_beforeHooks[(uint32_t)functionHookID];
+    auto table = m_hookTable.load(std::memory_order_acquire);
+    return table ? table->before[(uint32_t)functionHookID] : s_noHooks;
 }
 
 const HookList& PluginManager::getAfterHooksWithoutLazyInit(FunctionHookID functionHookID)
 {
-    return m_afterHooks[(uint32_t)functionHookID];
+    auto table = m_hookTable.load(std::memory_order_acquire);
+    return table ? table->after[(uint32_t)functionHookID] : s_noHooks;
 }
 
 PluginManager::PluginManager()
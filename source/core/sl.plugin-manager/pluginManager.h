@@ -54,7 +54,25 @@ namespace plugin_manager
 {
 
 using HookPair = std::pair<interposer::VirtualAddress, sl::Feature>;
-using HookList = std::vector<HookPair>;
+
+//! One hook per plugin per function at most
+constexpr uint32_t kMaxHooksPerFunction = 15;
+
+//! Immutable snapshot of the hooks registered for one FunctionHookID, sorted by plugin priority
+//!
+//! Plugin manager never modifies a published list, it builds a new table and swaps it in
+//! so interposer can iterate without any locks. Iterates as HookPair so call sites can
+//! keep using structured bindings, functions without hooks have 'count' of zero.
+struct alignas(64) HookList
+{
+    uint32_t count{};
+    HookPair hooks[kMaxHooksPerFunction]{};
+
+    inline bool empty() const { return count == 0; }
+    inline uint32_t size() const { return count; }
+    inline const HookPair* begin() const { return hooks; }
+    inline const HookPair* end() const { return hooks + count; }
+};
 
 using PFun_slSetDataInternal = Result(const sl::BaseStructure* inputs, sl::CommandBuffer* cmdBuffer);
 using PFun_slGetDataInternal = Result(const sl::BaseStructure* inputs, sl::BaseStructure* outputs, sl::CommandBuffer* cmdBuffer);
@@ -26,6 +26,7 @@
 #include "source/core/sl.api/internal.h"
 #include "include/sl.h"
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.trace/trace.h"
 #include "source/core/sl.file/file.h"
 #include "source/core/sl.extra/extra.h"
 #include "source/core/sl.param/parameters.h"
@@ -59,25 +60,94 @@ ILog* getInterface()
 }
 }
 
+namespace trace
+{
+ITrace* s_trace = {};
+ITrace* getInterface()
+{
+    return s_trace;
+}
+}
+
 namespace plugin
 {
 
+bool setLoaderConfig(api::Context* ctx, const void* config, size_t size)
+{
+    return ctx->loaderConfig.init(config, size);
+}
+
+//! JSON text (older plugin managers or debug 'useJSONPluginConfig' option) is converted to the
+//! binary layout so plugins only ever see one format. Empty text means plugin manager already
+//! provided the binary config through 'slOnPluginSetLoaderConfig'.
+//! 
+//! NOTE: Throws on malformed input, callers handle exceptions
+bool initLoaderConfig(api::Context* ctx, const char* config)
+{
+    if (!config || !config[0])
+    {
+        return ctx->loaderConfig.isInitialized();
+    }
+
+    json loader;
+    {
+        std::istringstream stream(config);
+        stream >> loader;
+    }
+
+    auto getVersion = [](const json& node, Version& v)->void
+    {
+        node.at("major").get_to(v.major);
+        node.at("minor").get_to(v.minor);
+        node.at("build").get_to(v.build);
+    };
+
+    api::LoaderConfigHeader header{};
+    if (loader.contains("host")) getVersion(loader.at("host").at("version"), header.host);
+    if (loader.contains("version")) getVersion(loader.at("version"), header.pluginManager);
+    if (loader.contains("api")) getVersion(loader.at("api"), header.api);
+    header.appId = loader.value("appId", 0);
+    header.deviceType = loader.value("deviceType", 0u);
+    header.interposerEnabled = loader.value("interposerEnabled", true);
+    header.forceNonNVDA = loader.value("forceNonNVDA", false);
+    std::string engineVersion, projectId;
+    if (loader.contains("ngx"))
+    {
+        loader.at("ngx").at("engineType").get_to(header.engineType);
+        loader.at("ngx").at("engineVersion").get_to(engineVersion);
+        loader.at("ngx").at("projectId").get_to(projectId);
+    }
+    if (loader.contains("preferences"))
+    {
+        loader.at("preferences").at("flags").get_to(header.preferenceFlags);
+    }
+    std::vector<std::string> paths;
+    if (loader.contains("paths"))
+    {
+        loader.at("paths").get_to(paths);
+    }
+
+    std::vector<uint8_t> blob;
+    api::writeLoaderConfig(header, engineVersion, projectId, paths, blob);
+    return ctx->loaderConfig.init(blob.data(), blob.size());
+}
+
 void onLoad(api::Context* ctx, const char* loaderJSON, const char* embeddedJSON)
 {
     // Setup logging and callbacks so we can report any issues correctly
     param::getPointerParam(api::getContext()->parameters, param::global::kLogInterface, &log::s_log);
+    param::getPointerParam(api::getContext()->parameters, param::global::kTraceInterface, &trace::s_trace);
 #ifndef SL_COMMON_PLUGIN
     param::getPointerParam(api::getContext()->parameters, param::common::kKeyboardAPI, &extra::keyboard::s_keyboard);
 #endif
 
     // Now let's populate our JSON config with our version and API
-    json& loader = *(json*)ctx->loaderConfig;
     json& config = *(json*)ctx->pluginConfig;
     try
     {
+        if (!initLoaderConfig(ctx, loaderJSON))
         {
-            std::istringstream stream(loaderJSON);
-            stream >> loader;
+            SL_LOG_ERROR("Invalid loader config provided by the plugin manager");
         }
 
         {
@@ -128,11 +198,11 @@ StartupResult onStartup(api::Context *ctx, const char* jsonConfig)
     try
     {
         // Get information provided by host (plugin manager or installed plugin)
-        json& config = *(json*)ctx->loaderConfig;
-
-        std::istringstream stream(jsonConfig);
-        stream >> config;
-
+        if (!initLoaderConfig(ctx, jsonConfig))
+        {
+            SL_LOG_ERROR("Invalid loader config provided by the plugin manager");
+            return eStartupResultFail;
+        }
     }
     catch (std::exception &e)
     {
@@ -147,10 +217,8 @@ void onShutdown(api::Context *ctx)
 {
     SL_LOG_INFO("Shutting down plugin %s", ctx->pluginName.c_str());
     delete ctx->pluginConfig;
-    delete ctx->loaderConfig;
     delete ctx->extConfig;
     ctx->pluginConfig = {};
-    ctx->loaderConfig = {};
     ctx->extConfig = {};
 }
 
@@ -24,6 +24,7 @@
 
 #include "include/sl_version.h"
 #include "source/core/sl.api/internal.h"
+#include "source/core/sl.api/loaderConfig.h"
 
 #define SL_EXPORT extern "C" __declspec(dllexport)
 SL_EXPORT BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID);
@@ -72,7 +73,6 @@ class Context
         sl::param::IParameters* _parameters,
         PFuncGetPluginFunction* _getPluginFunction,
         void* _pluginConfig,
-        void* _loaderConfig,
         void* _extConfig)
     {
         pluginName = _pluginName;
@@ -82,7 +82,6 @@ class Context
         parameters = _parameters;
         getPluginFunction = _getPluginFunction;
         pluginConfig = _pluginConfig;
-        loaderConfig = _loaderConfig;
         extConfig = _extConfig;
     };
 
@@ -93,10 +92,8 @@ class Context
     void onDestroyContext()
     {
         delete pluginConfig;
-        delete loaderConfig;
         delete extConfig;
         pluginConfig = {};
-        loaderConfig = {};
         extConfig = {};
     }
 
@@ -108,8 +105,9 @@ class Context
     sl::param::IParameters *parameters{};
     PFuncGetPluginFunction *getPluginFunction{};
     void* pluginConfig{};
-    void* loaderConfig{};
     void* extConfig{};
+    //! Provided by plugin manager on load and again on startup with the actual device type
+    LoaderConfig loaderConfig{};
 };
 
 Context *getContext();
@@ -166,6 +164,12 @@ bool slOnPluginLoad(sl::param::IParameters *params, const char* loaderJSON, cons
     return true;                                                                                           \
 }                                                                                                          \
                                                                                                            \
+/* Called before 'slOnPluginLoad' and 'slOnPluginStartup', these then receive empty loader JSON */         \
+bool slOnPluginSetLoaderConfig(const void* config, size_t size)                                            \
+{                                                                                                          \
+    return plugin::setLoaderConfig(api::getContext(), config, size);                                       \
+}                                                                                                          \
+                                                                                                           \
 }  /* namespace sl */                                                                                      \
                                                                                                            \
 /* Always in global namespace */                                                                           \
@@ -175,7 +179,7 @@ SL_EXPORT BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
     {                                                                                                      \
         case DLL_PROCESS_ATTACH:                                                                           \
             sl::api::s_ctx = new sl::api::Context(N, sl::V1, sl::V2, nullptr, nullptr, nullptr,            \
-                                        new json, new json, new json);                                     \
+                                        new json, new json);                                               \
             sl::PLUGIN_NAMESPACE::s_ctx = new sl::PLUGIN_NAMESPACE::PLUGIN_CTX();                          \
             break;                                                                                         \
         case DLL_THREAD_ATTACH:                                                                            \
@@ -222,6 +226,8 @@ enum StartupResult
 };
 
 //! Common plugin startup/shutdown code
+//! Loader config is either set upfront in binary form (see loaderConfig.h) or passed as JSON text
+bool setLoaderConfig(api::Context* ctx, const void* config, size_t size);
 void onLoad(api::Context *ctx, const char* loaderJSON, const char* embeddedJSON);
 StartupResult onStartup(api::Context *ctx, const char* jsonConfig);
 void onShutdown(api::Context *ctx);
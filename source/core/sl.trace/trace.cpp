@@ -0,0 +1,346 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifdef SL_WINDOWS
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "source/core/sl.trace/trace.h"
+#include "source/core/sl.log/log.h"
+#include "source/core/sl.file/file.h"
+
+namespace sl
+{
+namespace trace
+{
+
+constexpr uint32_t kMaxNumNames = 0xffff;
+
+struct Trace : public ITrace
+{
+    Trace()
+    {
+        m_names.push_back("overflow");
+    }
+
+    virtual void setEnabled(bool flag) override final
+    {
+        std::scoped_lock lock(m_mtx);
+        if (flag && !m_enabled.load())
+        {
+            calibrate(m_baseTimestamp, m_baseTimeNs);
+        }
+        m_enabled.store(flag);
+    }
+
+    virtual bool isEnabled() const override final
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    virtual uint16_t internName(const char* name) override final
+    {
+        std::scoped_lock lock(m_mtx);
+        auto it = m_nameIds.find(name);
+        if (it != m_nameIds.end()) return it->second;
+        if (m_names.size() >= kMaxNumNames)
+        {
+            SL_LOG_WARN_ONCE("Too many unique trace names, '%s' and any new ones will be reported as 'overflow'", name);
+            return 0;
+        }
+        auto id = (uint16_t)m_names.size();
+        m_names.push_back(name);
+        m_nameIds[name] = id;
+        return id;
+    }
+
+    virtual ThreadRing* acquireThreadRing() override final
+    {
+        auto ring = std::make_unique<ThreadRing>();
+        ring->enabled = &m_enabled;
+#ifdef SL_WINDOWS
+        ring->threadId = GetCurrentThreadId();
+#else
+        ring->threadId = (uint32_t)std::hash<std::thread::id>{}(std::this_thread::get_id());
+#endif
+        std::scoped_lock lock(m_mtx);
+        m_rings.push_back(std::move(ring));
+        return m_rings.back().get();
+    }
+
+    virtual bool exportChromeJSON(const wchar_t* path) override final
+    {
+        std::scoped_lock lock(m_mtx);
+
+        auto scale = getMicrosecondsPerTick();
+
+#ifdef SL_WINDOWS
+        auto pid = (uint32_t)GetCurrentProcessId();
+#else
+        auto pid = (uint32_t)getpid();
+#endif
+
+        std::string json = "{\"traceEvents\":[\n";
+        char buffer[256];
+        bool first = true;
+        auto append = [&json, &first](const char* str)->void
+        {
+            if (!first) json += ",\n";
+            json += str;
+            first = false;
+        };
+
+        std::vector<Event> events;
+        for (auto& ring : m_rings)
+        {
+            auto skip = copyRing(ring.get(), events);
+            if (skip == events.size()) continue;
+
+            snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"sl thread %u\"}}", pid, ring->threadId, ring->threadId);
+            append(buffer);
+
+            // Ends without a matching begin are left over from the part of the ring that was overwritten
+            uint32_t depth = 0;
+            for (size_t i = skip; i < events.size(); i++)
+            {
+                auto& e = events[i];
+                if (e.type == EventType::eEnd)
+                {
+                    if (depth == 0) continue;
+                    depth--;
+                }
+                else if (e.type == EventType::eBegin)
+                {
+                    depth++;
+                }
+                auto name = escape(e.name < m_names.size() ? m_names[e.name].c_str() : "unknown");
+                auto ts = e.timestamp > m_baseTimestamp ? double(e.timestamp - m_baseTimestamp) * scale : 0.0;
+                switch (e.type)
+                {
+                    case EventType::eBegin:
+                        snprintf(buffer, sizeof(buffer), "{\"name\":\"%s\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u,\"args\":{\"arg\":%u}}", name.c_str(), ts, pid, ring->threadId, e.arg);
+                        break;
+                    case EventType::eEnd:
+                        snprintf(buffer, sizeof(buffer), "{\"ph\":\"E\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u}", ts, pid, ring->threadId);
+                        break;
+                    case EventType::eInstant:
+                        snprintf(buffer, sizeof(buffer), "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u,\"args\":{\"arg\":%u}}", name.c_str(), ts, pid, ring->threadId, e.arg);
+                        break;
+                    case EventType::eCounter:
+                        snprintf(buffer, sizeof(buffer), "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u,\"args\":{\"value\":%u}}", name.c_str(), ts, pid, ring->threadId, e.arg);
+                        break;
+                }
+                append(buffer);
+            }
+        }
+        json += "\n]}\n";
+
+        file::write(path, std::vector<uint8_t>(json.begin(), json.end()));
+        if (!file::exists(path))
+        {
+            SL_LOG_ERROR("Failed to write trace to %S", path);
+            return false;
+        }
+        SL_LOG_INFO("Trace with events from %llu thread(s) saved to %S", (uint64_t)m_rings.size(), path);
+        return true;
+    }
+
+    virtual void logLatencySummary() override final
+    {
+        std::scoped_lock lock(m_mtx);
+
+        auto scale = getMicrosecondsPerTick();
+        auto itFrame = m_nameIds.find(kFrameBoundaryName);
+
+        // Scopes are matched per thread, only the outermost ones count towards the per frame total so nested SL calls are not counted twice
+        std::map<uint16_t, std::vector<double>> durations;
+        std::vector<uint64_t> frameBoundaries;
+        std::vector<std::pair<uint64_t, double>> outermost;
+        std::vector<Event> events;
+        std::vector<const Event*> stack;
+        for (auto& ring : m_rings)
+        {
+            auto skip = copyRing(ring.get(), events);
+            stack.clear();
+            for (size_t i = skip; i < events.size(); i++)
+            {
+                auto& e = events[i];
+                if (e.type == EventType::eBegin)
+                {
+                    stack.push_back(&e);
+                }
+                else if (e.type == EventType::eEnd && !stack.empty())
+                {
+                    auto begin = stack.back();
+                    stack.pop_back();
+                    auto us = e.timestamp > begin->timestamp ? double(e.timestamp - begin->timestamp) * scale : 0.0;
+                    durations[begin->name].push_back(us);
+                    if (stack.empty())
+                    {
+                        outermost.push_back({ begin->timestamp, us });
+                    }
+                }
+                else if (e.type == EventType::eInstant && itFrame != m_nameIds.end() && e.name == itFrame->second)
+                {
+                    frameBoundaries.push_back(e.timestamp);
+                }
+            }
+        }
+
+        if (durations.empty())
+        {
+            SL_LOG_INFO("No traced calls, nothing to summarize");
+            return;
+        }
+
+        // Only complete frames are reported, anything before the first or after the last boundary is partial
+        std::vector<double> frames;
+        if (frameBoundaries.size() > 1)
+        {
+            std::sort(frameBoundaries.begin(), frameBoundaries.end());
+            frames.resize(frameBoundaries.size() - 1);
+            for (auto& [timestamp, us] : outermost)
+            {
+                auto it = std::upper_bound(frameBoundaries.begin(), frameBoundaries.end(), timestamp);
+                if (it == frameBoundaries.begin() || it == frameBoundaries.end()) continue;
+                frames[size_t(it - frameBoundaries.begin()) - 1] += us;
+            }
+        }
+
+        SL_LOG_INFO("CPU latency in microseconds (count | p50 | p90 | p99 | max):");
+        for (auto& [name, values] : durations)
+        {
+            logDistribution(name < m_names.size() ? m_names[name].c_str() : "unknown", values);
+        }
+        if (!frames.empty())
+        {
+            logDistribution("per frame total", frames);
+        }
+    }
+
+    virtual void shutdown() override final
+    {
+        // Rings stay allocated since threads and plugins might still have them cached, they are simply not written to anymore
+        m_enabled.store(false);
+    }
+
+    inline static Trace* s_trace = {};
+
+private:
+
+    //! Copies what is in the ring now and returns the number of leading events the producer might have overwritten while we were copying
+    static size_t copyRing(const ThreadRing* ring, std::vector<Event>& events)
+    {
+        auto head = ring->head.load(std::memory_order_acquire);
+        auto tail = head > kThreadRingSize ? head - kThreadRingSize : 0;
+        events.resize(size_t(head - tail));
+        for (auto i = tail; i < head; i++)
+        {
+            events[size_t(i - tail)] = ring->events[i & (kThreadRingSize - 1)];
+        }
+        auto headAfterCopy = ring->head.load(std::memory_order_acquire);
+        auto validTail = headAfterCopy >= kThreadRingSize ? headAfterCopy - kThreadRingSize + 1 : 0;
+        return validTail > tail ? size_t(std::min(validTail, head) - tail) : 0;
+    }
+
+    //! TSC frequency is derived from the time elapsed since tracing was enabled
+    double getMicrosecondsPerTick() const
+    {
+        uint64_t nowTimestamp, nowNs;
+        calibrate(nowTimestamp, nowNs);
+        double scale = 1.0 / 1000.0;
+#ifdef SL_TRACE_USE_TSC
+        if (nowTimestamp > m_baseTimestamp)
+        {
+            scale = double(nowNs - m_baseTimeNs) / double(nowTimestamp - m_baseTimestamp) / 1000.0;
+        }
+#endif
+        return scale;
+    }
+
+    static void logDistribution(const char* name, std::vector<double>& values)
+    {
+        std::sort(values.begin(), values.end());
+        auto percentile = [&values](double p)->double
+        {
+            return values[std::min(size_t(p * values.size()), values.size() - 1)];
+        };
+        SL_LOG_INFO("%-24s %8llu | %8.2f | %8.2f | %8.2f | %8.2f", name, (uint64_t)values.size(), percentile(0.5), percentile(0.9), percentile(0.99), values.back());
+    }
+
+    static void calibrate(uint64_t& timestamp, uint64_t& ns)
+    {
+        timestamp = getTimestamp();
+        ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static std::string escape(const char* str)
+    {
+        // Length is capped to keep every record within the fixed size buffer used when exporting
+        std::string res;
+        for (; *str && res.size() < 126; str++)
+        {
+            if (*str == '"' || *str == '\\') res += '\\';
+            res += *str;
+        }
+        return res;
+    }
+
+    std::mutex m_mtx;
+    std::atomic<bool> m_enabled{};
+    uint64_t m_baseTimestamp{};
+    uint64_t m_baseTimeNs{};
+    std::vector<std::string> m_names;
+    std::unordered_map<std::string, uint16_t> m_nameIds;
+    std::vector<std::unique_ptr<ThreadRing>> m_rings;
+};
+
+ITrace* getInterface()
+{
+    if (!Trace::s_trace)
+    {
+        Trace::s_trace = new Trace();
+    }
+    return Trace::s_trace;
+}
+
+void destroyInterface()
+{
+    // Object is never deleted, rings and interned names are referenced from thread local and static storage in every module
+    if (Trace::s_trace)
+    {
+        Trace::s_trace->shutdown();
+    }
+}
+
+}
+}
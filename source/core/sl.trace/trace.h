@@ -0,0 +1,194 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define SL_TRACE_USE_TSC 1
+#endif
+
+//! Tracing is compiled out completely in production builds unless explicitly requested
+#ifndef SL_ENABLE_TRACING
+#ifdef SL_PRODUCTION
+#define SL_ENABLE_TRACING 0
+#else
+#define SL_ENABLE_TRACING 1
+#endif
+#endif
+
+namespace sl
+{
+namespace trace
+{
+
+enum class EventType : uint8_t
+{
+    eBegin,
+    eEnd,
+    eInstant,
+    eCounter
+};
+
+//! Raw event as recorded on the hot path, names are interned so only the id is stored
+struct Event
+{
+    uint64_t timestamp;
+    uint16_t name;
+    EventType type;
+    uint8_t reserved;
+    uint32_t arg;
+};
+static_assert(sizeof(Event) == 16, "trace events must stay 16 bytes");
+
+//! Single producer ring, only the owning thread writes while the exporter reads
+//!
+//! Oldest events are overwritten when the ring wraps around.
+constexpr uint32_t kThreadRingSize = 1 << 14;
+
+//! Instant recorded whenever a new frame token is issued, used to split traced calls into frames
+constexpr const char* kFrameBoundaryName = "slNewFrame";
+
+struct ThreadRing
+{
+    Event events[kThreadRingSize];
+    std::atomic<uint64_t> head{};
+    const std::atomic<bool>* enabled{};
+    uint32_t threadId{};
+
+    inline void record(uint16_t name, EventType type, uint32_t arg, uint64_t timestamp)
+    {
+        auto h = head.load(std::memory_order_relaxed);
+        auto& e = events[h & (kThreadRingSize - 1)];
+        e.timestamp = timestamp;
+        e.name = name;
+        e.type = type;
+        e.reserved = 0;
+        e.arg = arg;
+        head.store(h + 1, std::memory_order_release);
+    }
+};
+
+struct ITrace
+{
+    virtual void setEnabled(bool flag) = 0;
+    virtual bool isEnabled() const = 0;
+    //! Thread safe, returns the same id for the same string, 0 is reserved for overflow
+    virtual uint16_t internName(const char* name) = 0;
+    //! Returns ring for the calling thread, rings live until the process exits
+    virtual ThreadRing* acquireThreadRing() = 0;
+    //! Writes everything currently in the rings in Chrome trace event format (loads in chrome://tracing and Perfetto UI)
+    virtual bool exportChromeJSON(const wchar_t* path) = 0;
+    virtual void shutdown() = 0;
+    //! Logs per call and per frame CPU latency percentiles for everything currently in the rings
+    virtual void logLatencySummary() = 0;
+};
+
+ITrace* getInterface();
+void destroyInterface();
+
+inline uint64_t getTimestamp()
+{
+#ifdef SL_TRACE_USE_TSC
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+//! Ring is cached per thread and per module, returns null if tracing is not active
+inline ThreadRing* getThreadRing()
+{
+    thread_local ThreadRing* t_ring = {};
+    if (!t_ring)
+    {
+        auto trace = getInterface();
+        if (!trace || !trace->isEnabled()) return nullptr;
+        t_ring = trace->acquireThreadRing();
+        if (!t_ring) return nullptr;
+    }
+    return t_ring->enabled->load(std::memory_order_relaxed) ? t_ring : nullptr;
+}
+
+template<typename GetName>
+inline void record(GetName&& getName, EventType type, uint32_t arg)
+{
+    if (auto ring = getThreadRing())
+    {
+        ring->record(getName(), type, arg, getTimestamp());
+    }
+}
+
+struct Scope
+{
+    template<typename GetName>
+    inline Scope(GetName&& getName, uint32_t arg = 0)
+    {
+        if (auto ring = getThreadRing())
+        {
+            m_ring = ring;
+            m_name = getName();
+            ring->record(m_name, EventType::eBegin, arg, getTimestamp());
+        }
+    }
+    inline ~Scope()
+    {
+        if (m_ring)
+        {
+            m_ring->record(m_name, EventType::eEnd, 0, getTimestamp());
+        }
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ThreadRing* m_ring{};
+    uint16_t m_name{};
+};
+
+}
+}
+
+#define SL_TRACE_CONCAT_(a,b) a##b
+#define SL_TRACE_CONCAT(a,b) SL_TRACE_CONCAT_(a,b)
+
+//! Name is interned once per call site, only on the first call made while tracing is active
+#define SL_TRACE_NAME(NAME) []()->uint16_t { static const uint16_t s_id = sl::trace::getInterface()->internName(NAME); return s_id; }
+
+#if SL_ENABLE_TRACING
+#define SL_TRACE_SCOPE(NAME) sl::trace::Scope SL_TRACE_CONCAT(_slTraceScope, __LINE__)(SL_TRACE_NAME(NAME))
+#define SL_TRACE_SCOPE_ARG(NAME, ARG) sl::trace::Scope SL_TRACE_CONCAT(_slTraceScope, __LINE__)(SL_TRACE_NAME(NAME), (uint32_t)(ARG))
+#define SL_TRACE_INSTANT(NAME, ARG) sl::trace::record(SL_TRACE_NAME(NAME), sl::trace::EventType::eInstant, (uint32_t)(ARG))
+#define SL_TRACE_COUNTER(NAME, VALUE) sl::trace::record(SL_TRACE_NAME(NAME), sl::trace::EventType::eCounter, (uint32_t)(VALUE))
+#else
+#define SL_TRACE_SCOPE(NAME)
+#define SL_TRACE_SCOPE_ARG(NAME, ARG)
+#define SL_TRACE_INSTANT(NAME, ARG)
+#define SL_TRACE_COUNTER(NAME, VALUE)
+#endif
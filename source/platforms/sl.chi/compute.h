@@ -55,6 +55,8 @@ using Output = void*;
 constexpr uint32_t kAllSubResources = 0xffffffff;
 constexpr uint64_t kBinarySemaphoreValue = 0xcafec0de;
 constexpr const char* kGlobalVRAMSegment = "global";
+constexpr uint32_t kMaxNumVRAMSegments = 32;
+constexpr uint32_t kMaxVRAMSegmentNameLength = 64;
 
 #define SL_SAFE_RELEASE(a) if(a) { ((IUnknown*)a)->Release(); a = nullptr;}
 #define MAX_NUM_NODES 2
@@ -293,6 +295,15 @@ struct ResourceFootprint
     uint64_t totalBytes{};
 };
 
+//! Copy of the VRAM segment counters, see 'getVRAMSegmentStats'
+struct VRAMSegmentStats
+{
+    const char* name{};
+    uint64_t allocCount{};
+    uint64_t totalAllocatedSize{};
+    uint64_t peakAllocatedSize{};
+};
+
 struct Coordinates
 {
     int x;
@@ -417,6 +428,29 @@ struct HashedResource
     inline operator Resource() const { return resource; }
 };
 
+//! Controls how idle pooled resources are released when VRAM usage gets close to the budget
+//!
+//! Watermarks are fractions of the budget reported via 'setVRAMBudget'. Above the soft watermark resources
+//! idle for longer than 'softIdleMs' are released, above the hard one any idle resource can be released.
+//! Eviction stops once usage is back under the soft watermark, oldest and then largest resources go first.
+//! Pressure is only checked from 'collectGarbage', allocations never evict.
+struct ResourcePoolEvictionPolicy
+{
+    float softWatermark = 0.85f;
+    float hardWatermark = 0.95f;
+    float softIdleMs = 250.0f;
+};
+
+//! Totals for a single pool, pools do not share or rebalance memory so there is no per feature breakdown
+struct ResourcePoolStats
+{
+    //! Bytes held by idle resources which are ready to be recycled
+    uint64_t idleBytes{};
+    //! Totals since the pool was created, includes regular idle timeouts
+    uint64_t reclaimedBytes{};
+    uint64_t evictedCount{};
+};
+
 struct IResourcePool
 {
     virtual void setMaxQueueSize(size_t maxSize) = 0;
@@ -424,6 +458,8 @@ struct IResourcePool
     virtual void recycle(HashedResource res) = 0;
     virtual void clear() = 0;
     virtual void collectGarbage(float deltaMs = 10000.0f) = 0;
+    virtual void setEvictionPolicy(const ResourcePoolEvictionPolicy& policy) = 0;
+    virtual void getStats(ResourcePoolStats& stats) = 0;
 };
 
 // Common functions
@@ -556,7 +592,11 @@ public:
     virtual ComputeStatus stopTrackingResource(uint32_t id) = 0;
 
     // Hooks up back to the SL command list to restore its state
+    // 
+    // NOTE: D3D12 skips the restore unless SL changed pipeline state on this command list since the last one,
+    // chi tracks its own binds while work recorded outside of chi (NGX etc.) must be reported via 'invalidatePipeline'
     virtual ComputeStatus restorePipeline(CommandList cmdList) = 0;
+    virtual ComputeStatus invalidatePipeline(CommandList cmdList) = 0;
 
     virtual ComputeStatus insertGPUBarrier(CommandList cmdList, Resource resource, BarrierType barrierType = eBarrierTypeUAV) = 0;
     virtual ComputeStatus insertGPUBarrierList(CommandList cmdList, const Resource* resources, uint32_t resourceCount, BarrierType barrierType = eBarrierTypeUAV) = 0;
@@ -619,6 +659,11 @@ public:
 
     // OFA
     virtual ComputeStatus isNativeOpticalFlowSupported() = 0;
+
+    // VRAM tracking
+    //! Lock free, fills up to 'count' entries and returns number of segments in 'count', global segment is always first
+    virtual ComputeStatus getVRAMSegmentStats(VRAMSegmentStats* stats, uint32_t& count) = 0;
+    virtual ComputeStatus getVRAMUsage(uint64_t& currentUsageBytes, uint64_t& budgetBytes) = 0;
 };
 
 ICompute* getD3D11();
@@ -25,6 +25,7 @@
 #include <cmath>
 #include <d3dcompiler.h>
 #include <future>
+#include <bit>
 
 #include "source/core/sl.log/log.h"
 #include "source/core/sl.interposer/d3d12/d3d12.h"
@@ -758,14 +759,21 @@ ComputeStatus D3D12::init(Device device, param::IParameters* params)
     }
 
     m_heap = new HeapInfo;
+    m_heap->nodeCount = NodeCount;
+    m_heap->generation.resize(SL_MAX_D3D12_DESCRIPTORS);
+    // Hand out low indices first
+    m_heap->freeList.resize(SL_MAX_D3D12_DESCRIPTORS);
+    for (UINT i = 0; i < SL_MAX_D3D12_DESCRIPTORS; i++)
+    {
+        m_heap->freeList[i] = SL_MAX_D3D12_DESCRIPTORS - 1 - i;
+    }
 
     for(UINT Node = 0; Node < NodeCount; Node++)
     {
         // create desc heaps for SRV/UAV/CBV
         {
             D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-            // Each wraparound we target a different part of the heap to prevent direct reuse
-            heapDesc.NumDescriptors = SL_MAX_D3D12_DESCRIPTORS * SL_DESCRIPTOR_WRAPAROUND_CAPACITY;
+            heapDesc.NumDescriptors = SL_MAX_D3D12_DESCRIPTORS;
             heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
             heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
             heapDesc.NodeMask = (1 << Node);
@@ -850,11 +858,17 @@ ComputeStatus D3D12::shutdown()
 
 ComputeStatus D3D12::clearCache()
 {
-    for (auto& resources : m_resourceData)
     {
-        resources.second.clear();
+        std::scoped_lock lock(m_mutexResource);
+        for (auto& [resource, views] : m_resourceData)
+        {
+            for (auto& [hash, data] : views)
+            {
+                releaseDescIndex(data.descIndex, false);
+            }
+        }
+        m_resourceData.clear();
     }
-    m_resourceData.clear();
 
     return Generic::clearCache();
 }
@@ -865,11 +879,77 @@ ComputeStatus D3D12::getRenderAPI(RenderAPI &OutType)
     return ComputeStatus::eOk;
 }
 
+//! Replays only root arguments host has actually set, compute and graphics differ just in the entry points
+template<bool kGraphics>
+void restoreRootState(ID3D12GraphicsCommandList* cmdList, const interposer::RootState& state)
+{
+    using ArgType = interposer::RootState::ArgType;
+
+    if (!state.rootSignature) return;
+
+    if constexpr (kGraphics) cmdList->SetGraphicsRootSignature(state.rootSignature);
+    else cmdList->SetComputeRootSignature(state.rootSignature);
+
+    for (auto mask = state.setMask; mask; mask &= mask - 1)
+    {
+        auto index = (UINT)std::countr_zero(mask);
+        auto arg = state.args[index];
+        switch (state.types[index])
+        {
+            case ArgType::eTable:
+                if constexpr (kGraphics) cmdList->SetGraphicsRootDescriptorTable(index, { arg });
+                else cmdList->SetComputeRootDescriptorTable(index, { arg });
+                break;
+            case ArgType::eCBV:
+                if constexpr (kGraphics) cmdList->SetGraphicsRootConstantBufferView(index, arg);
+                else cmdList->SetComputeRootConstantBufferView(index, arg);
+                break;
+            case ArgType::eSRV:
+                if constexpr (kGraphics) cmdList->SetGraphicsRootShaderResourceView(index, arg);
+                else cmdList->SetComputeRootShaderResourceView(index, arg);
+                break;
+            case ArgType::eUAV:
+                if constexpr (kGraphics) cmdList->SetGraphicsRootUnorderedAccessView(index, arg);
+                else cmdList->SetComputeRootUnorderedAccessView(index, arg);
+                break;
+            case ArgType::eConstants:
+            {
+                // One call per contiguous range of constants which were set
+                auto constants = state.constantMasks[index];
+                while (constants)
+                {
+                    auto offset = (UINT)std::countr_zero(constants);
+                    auto count = (UINT)std::countr_one(constants >> offset);
+                    if constexpr (kGraphics) cmdList->SetGraphicsRoot32BitConstants(index, count, state.constants[index] + offset, offset);
+                    else cmdList->SetComputeRoot32BitConstants(index, count, state.constants[index] + offset, offset);
+                    constants = offset + count < 64 ? constants & (~0ull << (offset + count)) : 0;
+                }
+                break;
+            }
+        }
+    }
+}
+
+ComputeStatus D3D12::invalidatePipeline(CommandList cmdBuffer)
+{
+    // No thread context when running as d3d11 on 12, nothing gets restored there anyway
+    if (!m_getThreadContext) return ComputeStatus::eOk;
+
+    D3D12ThreadContext* thread = (D3D12ThreadContext*)m_getThreadContext();
+    thread->pipelineDirty = cmdBuffer;
+    return ComputeStatus::eOk;
+}
+
 ComputeStatus D3D12::restorePipeline(CommandList cmdBuffer)
 {
     if (!cmdBuffer) return ComputeStatus::eOk;
 
     D3D12ThreadContext* thread = (D3D12ThreadContext*)m_getThreadContext();
+
+    // Host state is still bound if we have not recorded anything on top of it since the last restore
+    if (thread->pipelineDirty != cmdBuffer) return ComputeStatus::eOk;
+    thread->pipelineDirty = {};
+
     auto cmdList = ((ID3D12GraphicsCommandList*)cmdBuffer);
     
     assert(thread->cmdList->m_base == cmdBuffer);
@@ -878,30 +958,9 @@ ComputeStatus D3D12::restorePipeline(CommandList cmdBuffer)
     {
         cmdList->SetDescriptorHeaps(thread->cmdList->m_numHeaps, thread->cmdList->m_heaps);
     }
-    if (thread->cmdList->m_rootSignature)
-    {
-        cmdList->SetComputeRootSignature(thread->cmdList->m_rootSignature);
-        for (auto& pair : thread->cmdList->m_mapHandles)
-        {
-            cmdList->SetComputeRootDescriptorTable(pair.first, pair.second);
-        }
-        for (auto& pair : thread->cmdList->m_mapCBV)
-        {
-            cmdList->SetComputeRootConstantBufferView(pair.first, pair.second);
-        }
-        for (auto& pair : thread->cmdList->m_mapSRV)
-        {
-            cmdList->SetComputeRootShaderResourceView(pair.first, pair.second);
-        }
-        for (auto& pair : thread->cmdList->m_mapUAV)
-        {
-            cmdList->SetComputeRootUnorderedAccessView(pair.first, pair.second);
-        }
-        for (auto& pair : thread->cmdList->m_mapConstants)
-        {
-            cmdList->SetComputeRoot32BitConstants(pair.first, pair.second.Num32BitValuesToSet, pair.second.SrcData, pair.second.DestOffsetIn32BitValues);
-        }
-    }
+    // Changing descriptor heaps invalidates descriptor tables on both pipelines so graphics state needs restoring too
+    restoreRootState<false>(cmdList, thread->cmdList->m_compute);
+    restoreRootState<true>(cmdList, thread->cmdList->m_graphics);
     if (thread->cmdList->m_pso)
     {
         cmdList->SetPipelineState(thread->cmdList->m_pso);
@@ -1295,6 +1354,7 @@ ComputeStatus D3D12::bindSharedState(CommandList InCmdList, UINT node)
 
     ID3D12DescriptorHeap *Heaps[] = { m_heap->descriptorHeap[ctx.node] };
     ctx.cmdList->SetDescriptorHeaps(1, Heaps);
+    invalidatePipeline(ctx.cmdList);
 
     return ComputeStatus::eOk;
 }
@@ -1573,6 +1633,7 @@ ComputeStatus D3D12::dispatch(uint32_t blocksX, uint32_t blocksY, uint32_t block
 
         ctx.cmdList->SetComputeRootSignature(kdd.rootSignature);
         ctx.cmdList->SetPipelineState(kdd.pso);
+        invalidatePipeline(ctx.cmdList);
 
         //! Set root parameters by accounting for the empty sampler slot(s) (if any)
         //! 
@@ -1652,27 +1713,91 @@ size_t D3D12::hashRootSignature(const CD3DX12_ROOT_SIGNATURE_DESC& desc)
     return h;
 }
 
-UINT D3D12::getNewAndIncreaseDescIndex()
+//! NOTE: Methods below expect 'm_mutexResource' to be locked by the caller
+
+bool D3D12::allocateDescIndex(UINT& index, uint32_t& generation)
 {
-    // This method is thread safe since it is just a helper for cache texture or surface
+    auto finishedFrame = m_finishedFrame.load();
+    auto& heap = *m_heap;
 
-    auto node = 0; // FIX THIS
-    if ((m_heap->descIndex[node] + 1) >= SL_MAX_D3D12_DESCRIPTORS)
+    // Recycle descriptors which GPU is done with
+    while (!heap.retired.empty() && finishedFrame > heap.retired.front().frame + SL_DESCRIPTOR_RETIRE_FRAME_DELAY)
     {
-        // We've looped around our Descriptor heap
-        // There's no way we can keep the old cached Descriptors as valid..
-        // Invalidate all caches and force the SetInput() calls to set up new ones
-        // It will be a slow burn for a while, but hopefully that isn't too frequent ??
-        SL_LOG_WARN("D3D12 Descriptor heap wrap around. Clearing all cache and reallocating from scratch again. This is impacting performance - please do NOT change the tagged resources every frame");
-        memset(m_heap->descIndex, 0, MAX_NUM_NODES * sizeof(UINT));
-        assert(m_heap->descIndex[node] == 0);
-        m_heap->wrapAroundCount = (m_heap->wrapAroundCount + 1) % SL_DESCRIPTOR_WRAPAROUND_CAPACITY;
-        m_resourceData.clear();
+        heap.freeList.push_back(heap.retired.front().index);
+        heap.retired.pop_front();
     }
-    UINT ReturnedIndex = m_heap->descIndex[node] + SL_MAX_D3D12_DESCRIPTORS * m_heap->wrapAroundCount;
-    m_heap->descIndex[node] = (m_heap->descIndex[node] + 1) % SL_MAX_D3D12_DESCRIPTORS;
 
-    return ReturnedIndex;
+    if (heap.freeList.empty() && evictColdDescriptors() == 0)
+    {
+        SL_LOG_ERROR("D3D12 descriptor heap exhausted, all %u descriptors were used in the last %u frames - please do NOT change the tagged resources every frame", SL_MAX_D3D12_DESCRIPTORS, SL_DESCRIPTOR_RETIRE_FRAME_DELAY);
+        return false;
+    }
+
+    index = heap.freeList.back();
+    heap.freeList.pop_back();
+    generation = heap.generation[index];
+    return true;
+}
+
+void D3D12::releaseDescIndex(UINT index, bool gpuDone)
+{
+    if (!m_heap || index >= m_heap->generation.size()) return;
+
+    m_heap->generation[index]++;
+    if (gpuDone)
+    {
+        m_heap->freeList.push_back(index);
+    }
+    else
+    {
+        m_heap->retired.push_back({ index, m_finishedFrame.load() });
+    }
+}
+
+uint32_t D3D12::evictColdDescriptors()
+{
+    // Views not requested since before the last retire window are no longer referenced by the GPU
+    // so they go straight back to the free list, oldest first
+    auto finishedFrame = m_finishedFrame.load();
+    struct Candidate
+    {
+        uint32_t lastUsedFrame;
+        void* resource;
+        uint32_t hash;
+    };
+    std::vector<Candidate> candidates;
+    for (auto& [resource, views] : m_resourceData)
+    {
+        for (auto& [hash, data] : views)
+        {
+            if (finishedFrame > data.lastUsedFrame + SL_DESCRIPTOR_RETIRE_FRAME_DELAY)
+            {
+                candidates.push_back({ data.lastUsedFrame, resource, hash });
+            }
+        }
+    }
+
+    auto count = std::min((uint32_t)candidates.size(), SL_DESCRIPTOR_EVICTION_BATCH);
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [](const Candidate& a, const Candidate& b)->bool
+    {
+        return a.lastUsedFrame < b.lastUsedFrame;
+    });
+    for (uint32_t i = 0; i < count; i++)
+    {
+        auto it = m_resourceData.find(candidates[i].resource);
+        auto& views = (*it).second;
+        releaseDescIndex(views[candidates[i].hash].descIndex, true);
+        views.erase(candidates[i].hash);
+        if (views.empty())
+        {
+            m_resourceData.erase(it);
+        }
+    }
+    if (count)
+    {
+        SL_LOG_VERBOSE("Evicted %u cold descriptor(s) - finished frame %u", count, finishedFrame);
+    }
+    return count;
 }
 
 ComputeStatus D3D12::getTextureDriverData(Resource res, ResourceDriverData &data, uint32_t mipOffset, uint32_t mipLevels, Sampler sampler)
@@ -1688,9 +1813,10 @@ ComputeStatus D3D12::getTextureDriverData(Resource res, ResourceDriverData &data
     auto it = m_resourceData.find(resource);
     if (it == m_resourceData.end() || (*it).second.find(hash) == (*it).second.end())
     {
-        auto node = 0; // FIX THIS
-        data.descIndex = getNewAndIncreaseDescIndex();
-        auto currentCPUHandle =  CD3DX12_CPU_DESCRIPTOR_HANDLE(m_heap->descriptorHeap[node]->GetCPUDescriptorHandleForHeapStart(), data.descIndex, m_descriptorSize);
+        if (!allocateDescIndex(data.descIndex, data.generation))
+        {
+            return ComputeStatus::eError;
+        }
 
         D3D12_RESOURCE_DESC desc = resource->GetDesc();
 
@@ -1702,18 +1828,26 @@ ComputeStatus D3D12::getTextureDriverData(Resource res, ResourceDriverData &data
         SRVDesc.Texture2D.MostDetailedMip = mipOffset;
 
         auto name = getDebugName(res);
-        SL_LOG_VERBOSE("Caching texture 0x%llx(%S) node %u fmt %s size (%u,%u) mip %u mips %u sampler[%d]", resource, name.c_str(), node, getDXGIFormatStr(desc.Format), (UINT)desc.Width, (UINT)desc.Height, SRVDesc.Texture2D.MostDetailedMip, SRVDesc.Texture2D.MipLevels, sampler);
+        SL_LOG_VERBOSE("Caching texture 0x%llx(%S) index %u fmt %s size (%u,%u) mip %u mips %u sampler[%d]", resource, name.c_str(), data.descIndex, getDXGIFormatStr(desc.Format), (UINT)desc.Width, (UINT)desc.Height, SRVDesc.Texture2D.MostDetailedMip, SRVDesc.Texture2D.MipLevels, sampler);
 
-        m_device->CreateShaderResourceView(resource, &SRVDesc, currentCPUHandle);
+        for (UINT node = 0; node < m_heap->nodeCount; node++)
+        {
+            auto cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_heap->descriptorHeap[node]->GetCPUDescriptorHandleForHeapStart(), data.descIndex, m_descriptorSize);
+            m_device->CreateShaderResourceView(resource, &SRVDesc, cpuHandle);
+        }
 
         data.heap = m_heap;
+        data.lastUsedFrame = m_finishedFrame.load();
 
         m_resourceData[resource][hash] = data;
     }
     else
     {
-        data = (*it).second[hash];
+        auto& cached = (*it).second[hash];
+        cached.lastUsedFrame = m_finishedFrame.load();
+        data = cached;
     }
+    assert(m_heap->isValid(data.descIndex, data.generation));
     assert(data.heap == m_heap);
     return ComputeStatus::eOk;
 }
@@ -1731,9 +1865,6 @@ ComputeStatus D3D12::getSurfaceDriverData(Resource res, ResourceDriverData &data
     auto it = m_resourceData.find(resource);
     if (it == m_resourceData.end() || (*it).second.find(hash) == (*it).second.end())
     {
-        auto node = 0; // FIX THIS
-        data.descIndex = getNewAndIncreaseDescIndex();
-
         D3D12_RESOURCE_DESC desc = resource->GetDesc();
 
         auto name = getDebugName(res);
@@ -1748,7 +1879,7 @@ ComputeStatus D3D12::getSurfaceDriverData(Resource res, ResourceDriverData &data
             UAVDesc.Buffer.NumElements = (UINT)desc.Width / 4;
             UAVDesc.Buffer.StructureByteStride = 0;
 
-            SL_LOG_VERBOSE("Caching raw buffer 0x%llx(%S) node %u fmt %s size (%u,%u)", resource, name.c_str(), node, getDXGIFormatStr(desc.Format), (UINT)desc.Width, (UINT)desc.Height);
+            SL_LOG_VERBOSE("Caching raw buffer 0x%llx(%S) fmt %s size (%u,%u)", resource, name.c_str(), getDXGIFormatStr(desc.Format), (UINT)desc.Width, (UINT)desc.Height);
         }
         else
         {
@@ -1762,22 +1893,35 @@ ComputeStatus D3D12::getSurfaceDriverData(Resource res, ResourceDriverData &data
                 return ComputeStatus::eError;
             }
 
-            SL_LOG_VERBOSE("Caching rwtexture 0x%llx(%S) node %u fmt %s size (%u,%u) mip %u", resource, name.c_str(), node, getDXGIFormatStr(desc.Format), (UINT)desc.Width, (UINT)desc.Height, UAVDesc.Texture2D.MipSlice);
+            SL_LOG_VERBOSE("Caching rwtexture 0x%llx(%S) fmt %s size (%u,%u) mip %u", resource, name.c_str(), getDXGIFormatStr(desc.Format), (UINT)desc.Width, (UINT)desc.Height, UAVDesc.Texture2D.MipSlice);
         }
-        
+
+        if (!allocateDescIndex(data.descIndex, data.generation))
+        {
+            return ComputeStatus::eError;
+        }
+
+        // Non shader visible copy is needed for UAV clears
+        for (UINT node = 0; node < m_heap->nodeCount; node++)
         {
             auto cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_heap->descriptorHeap[node]->GetCPUDescriptorHandleForHeapStart(), data.descIndex, m_descriptorSize);
             m_device->CreateUnorderedAccessView(resource, nullptr, &UAVDesc, cpuHandle);
+            cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_heap->descriptorHeapCPU[node]->GetCPUDescriptorHandleForHeapStart(), data.descIndex, m_descriptorSize);
+            m_device->CreateUnorderedAccessView(resource, nullptr, &UAVDesc, cpuHandle);
         }
 
         data.heap = m_heap;
+        data.lastUsedFrame = m_finishedFrame.load();
 
         m_resourceData[resource][hash] = data;
     }
     else
     {
-        data = (*it).second[hash];
+        auto& cached = (*it).second[hash];
+        cached.lastUsedFrame = m_finishedFrame.load();
+        data = cached;
     }
+    assert(m_heap->isValid(data.descIndex, data.generation));
     assert(data.heap == m_heap);
 
     return ComputeStatus::eOk;
@@ -2062,7 +2206,13 @@ ComputeStatus D3D12::clearView(CommandList InCmdList, Resource resource, const f
     ResourceDriverData Data = {};
     if (getSurfaceDriverData(resource, Data) == ComputeStatus::eOk)
     {
-        auto node = 0; // FIX THIS
+        // Same node 'bindSharedState' selected for this thread, the descriptor index is valid in every node's heap
+        auto node = m_dispatchContext.getContext().node;
+        if (node >= m_heap->nodeCount)
+        {
+            SL_LOG_ERROR("Invalid node %u for clear view", node);
+            return ComputeStatus::eError;
+        }
         CD3DX12_CPU_DESCRIPTOR_HANDLE CPUVisibleCPUHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_heap->descriptorHeapCPU[node]->GetCPUDescriptorHandleForHeapStart(), Data.descIndex, m_descriptorSize);
         CD3DX12_GPU_DESCRIPTOR_HANDLE GPUHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_heap->descriptorHeap[node]->GetGPUDescriptorHandleForHeapStart(), Data.descIndex, m_descriptorSize);
 
@@ -2424,6 +2574,11 @@ int D3D12::destroyResourceDeferredImpl(const Resource resource)
     auto it = m_resourceData.find(resource->native);
     if (it != m_resourceData.end())
     {
+        // Resource destruction is already delayed until GPU is done with it, same goes for its views
+        for (auto& [hash, data] : (*it).second)
+        {
+            releaseDescIndex(data.descIndex, true);
+        }
         m_resourceData.erase(it);
     }
     auto unknown = (IUnknown*)(resource->native);
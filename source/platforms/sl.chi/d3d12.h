@@ -25,6 +25,7 @@
 #include <d3d12.h>
 #include <future>
 #include <array>
+#include <deque>
 
 #include "source/core/sl.thread/thread.h"
 #include "source/platforms/sl.chi/generic.h"
@@ -42,10 +43,15 @@ constexpr int kHeapCount = 4;
 struct D3D12ThreadContext : public CommonThreadContext
 {
     interposer::D3D12GraphicsCommandList* cmdList = {};
+    //! Native command list SL has changed pipeline state on since the last 'restorePipeline', if any
+    CommandList pipelineDirty = {};
 };
 
-constexpr unsigned int SL_MAX_D3D12_DESCRIPTORS          = 1024;
-constexpr unsigned int SL_DESCRIPTOR_WRAPAROUND_CAPACITY = 2;
+constexpr unsigned int SL_MAX_D3D12_DESCRIPTORS          = 4096;
+//! Released descriptors are not reused before GPU finishes this many frames, same as the default delay in 'destroyResource'
+constexpr unsigned int SL_DESCRIPTOR_RETIRE_FRAME_DELAY  = 3;
+//! Number of cold views evicted at once when the heap runs out of free descriptors
+constexpr unsigned int SL_DESCRIPTOR_EVICTION_BATCH      = SL_MAX_D3D12_DESCRIPTORS / 8;
 
 class GpuUploadBuffer
 {
@@ -223,15 +229,28 @@ struct DispatchDataD3D12
     uint32_t node = 0;
 };
 
+struct RetiredDescriptor
+{
+    UINT index;
+    uint32_t frame;
+};
+
+//! Descriptor indices are shared by all nodes, each view is written to every node's heap at the same index
+//!
+//! Indices come from a free list, released ones are retired first since command lists
+//! recorded in the last few frames can still reference them.
 struct HeapInfo
 {
     ID3D12DescriptorHeap *descriptorHeap[MAX_NUM_NODES] = {};
     ID3D12DescriptorHeap *descriptorHeapCPU[MAX_NUM_NODES] = {};
+    UINT nodeCount = 1;
 
-    UINT descIndex[MAX_NUM_NODES] = {0,0};
+    std::vector<UINT> freeList;
+    std::deque<RetiredDescriptor> retired;
+    //! Bumped every time index is released so stale copies of the driver data can be detected
+    std::vector<uint32_t> generation;
 
-    // Number of time we've wrapped around our Descriptor heap
-    unsigned int wrapAroundCount = 0;
+    inline bool isValid(UINT index, uint32_t gen) const { return index < generation.size() && generation[index] == gen; }
 };
 
 struct ResourceDriverData
@@ -240,6 +259,9 @@ struct ResourceDriverData
     uint64_t virtualAddress = 0;
     uint64_t size = 0;
     uint32_t descIndex = 0;
+    uint32_t generation = 0;
+    //! Last finished frame at the time this view was requested, used to evict cold views
+    uint32_t lastUsedFrame = 0;
     bool bZBCSupported = false;
     HeapInfo *heap = {};
 };
@@ -291,7 +313,9 @@ class D3D12 : public Generic
     bool dx11On12 = false;
     bool isSupportedFormat(DXGI_FORMAT format, int flag1, int flag2);
     DXGI_FORMAT getCorrectFormat(DXGI_FORMAT Format);
-    UINT getNewAndIncreaseDescIndex();
+    bool allocateDescIndex(UINT& index, uint32_t& generation);
+    void releaseDescIndex(UINT index, bool gpuDone);
+    uint32_t evictColdDescriptors();
 
     inline D3D12_RESOURCE_STATES toD3D12States(ResourceState state)
     {
@@ -310,6 +334,7 @@ public:
     virtual ComputeStatus getRenderAPI(RenderAPI &OutType) override final;
 
     virtual ComputeStatus restorePipeline(CommandList cmdList)  override final;
+    virtual ComputeStatus invalidatePipeline(CommandList cmdList)  override final;
 
     virtual ComputeStatus getNativeResourceState(ResourceState state, uint32_t& nativeState) override final;
     virtual ComputeStatus getResourceState(uint32_t nativeState, ResourceState& state) override final;
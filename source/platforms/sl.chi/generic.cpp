@@ -31,6 +31,7 @@
 #include <string.h>
 #include <fstream>
 #include <map>
+#include <algorithm>
 #include <unordered_set>
 
 struct IDXGIAdapter;
@@ -38,7 +39,9 @@ struct IDXGISwapChain;
 
 #include "include/sl_helpers.h"
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.trace/trace.h"
 #include "source/core/sl.extra/extra.h"
+#include "source/core/sl.extra/arena.h"
 #include "source/core/sl.param/parameters.h"
 #include "source/platforms/sl.chi/generic.h"
 #include "external/nvapi/nvapi.h"
@@ -86,6 +89,10 @@ namespace chi
 
 #define SL_DEBUG_RESOURCE_POOL 0
 
+//! Budget reported by the OS lags behind our deferred releases, bytes evicted under pressure
+//! are assumed to be gone for this many 'collectGarbage' calls so we do not evict twice for the same overage
+constexpr uint32_t kResourcePoolEvictionSettleCount = 4;
+
 struct ResourcePool : IResourcePool
 {
     using TimestampedResource = std::pair<std::chrono::system_clock::time_point, HashedResource>;
@@ -99,6 +106,7 @@ struct ResourcePool : IResourcePool
 
     virtual HashedResource allocate(Resource source, const char* debugName, ResourceState initialState) override final
     {
+        SL_TRACE_SCOPE("ResourcePool.allocate");
         ResourceDescription desc;
         m_compute->getResourceDescription(source, desc);
         desc.state = initialState;
@@ -254,6 +262,8 @@ struct ResourcePool : IResourcePool
                     std::chrono::duration<float, std::milli> deltaSinceLastUsed = std::chrono::system_clock::now() - timestamp;
                     if (deltaSinceLastUsed.count() > deltaMs)
                     {
+                        m_stats.reclaimedBytes += getFootprint(resource);
+                        m_stats.evictedCount++;
                         m_compute->destroyResource(resource,0);
                         it1 = (*it).second.erase(it1);
                         continue;
@@ -273,20 +283,109 @@ struct ResourcePool : IResourcePool
 #endif
             it++;
         }
+        evictUnderPressure();
         m_compute->endVRAMSegment();
     }
 
+    virtual void setEvictionPolicy(const ResourcePoolEvictionPolicy& policy) override final
+    {
+        std::scoped_lock lock(m_mtx);
+        m_policy = policy;
+        m_policy.hardWatermark = std::max(m_policy.hardWatermark, m_policy.softWatermark);
+    }
+
+    virtual void getStats(ResourcePoolStats& stats) override final
+    {
+        std::scoped_lock lock(m_mtx);
+        stats = m_stats;
+        stats.idleBytes = 0;
+        for (auto& [hash, list] : m_free)
+        {
+            for (auto& [timestamp, resource] : list)
+            {
+                stats.idleBytes += getFootprint(resource);
+            }
+        }
+    }
+
+    //! NOTE: Only resources sitting in the free lists are considered, anything handed out
+    //! by 'allocate' and not recycled yet is in use. Evicted resources still go through
+    //! the regular delayed destroy since GPU could be reading them from the last few frames.
+    void evictUnderPressure()
+    {
+        if (m_pendingEvictionCount > 0 && --m_pendingEvictionCount == 0)
+        {
+            m_pendingEvictionBytes = 0;
+        }
+
+        uint64_t usage{}, budget{};
+        if (m_compute->getVRAMUsage(usage, budget) != ComputeStatus::eOk) return;
+
+        usage = usage > m_pendingEvictionBytes ? usage - m_pendingEvictionBytes : 0;
+        auto softBytes = uint64_t(budget * double(m_policy.softWatermark));
+        auto hardBytes = uint64_t(budget * double(m_policy.hardWatermark));
+        if (usage <= softBytes) return;
+
+        bool hardPressure = usage > hardBytes;
+        struct Candidate
+        {
+            float idleMs;
+            uint64_t bytes;
+            uint64_t hash;
+            Resource resource;
+        };
+        std::vector<Candidate> candidates;
+        auto now = std::chrono::system_clock::now();
+        for (auto& [hash, list] : m_free)
+        {
+            for (auto& [timestamp, resource] : list)
+            {
+                std::chrono::duration<float, std::milli> idle = now - timestamp;
+                if (hardPressure || idle.count() > m_policy.softIdleMs)
+                {
+                    candidates.push_back({ idle.count(), getFootprint(resource), hash, resource.resource });
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)->bool
+        {
+            return a.idleMs != b.idleMs ? a.idleMs > b.idleMs : a.bytes > b.bytes;
+        });
+
+        uint64_t reclaimed = 0;
+        uint32_t count = 0;
+        for (auto& candidate : candidates)
+        {
+            if (usage - std::min(usage, reclaimed) <= softBytes) break;
+            auto& list = m_free[candidate.hash];
+            auto it = std::find_if(list.begin(), list.end(), [&candidate](const TimestampedResource& item)->bool { return item.second.resource == candidate.resource; });
+            if (it == list.end()) continue;
+            m_compute->destroyResource(candidate.resource);
+            list.erase(it);
+            reclaimed += candidate.bytes;
+            count++;
+        }
+        if (count)
+        {
+            m_stats.reclaimedBytes += reclaimed;
+            m_stats.evictedCount += count;
+            m_pendingEvictionBytes += reclaimed;
+            m_pendingEvictionCount = kResourcePoolEvictionSettleCount;
+            SL_LOG_VERBOSE("'%s' evicted %u idle resource(s) %.2fMB - usage %.2fMB budget %.2fMB %s watermark", m_vramSegment.c_str(), count, reclaimed / (1024.0 * 1024.0),
+                usage / (1024.0 * 1024.0), budget / (1024.0 * 1024.0), hardPressure ? "hard" : "soft");
+        }
+    }
+
+    inline uint64_t getFootprint(Resource resource) const
+    {
+        ResourceFootprint footprint{};
+        m_compute->getResourceFootprint(resource, footprint);
+        return footprint.totalBytes;
+    }
+
     uint64_t getHash(const ResourceDescription& desc) const
     {
-        uint64_t hash = 0;
-        hash_combine(hash, desc.width);
-        hash_combine(hash, desc.height);
-        hash_combine(hash, desc.format);
-        hash_combine(hash, desc.mips);
-        hash_combine(hash, desc.depth);
-        hash_combine(hash, desc.flags);
-        hash_combine(hash, desc.state);
-        return hash;
+        return getResourceDescriptionHash(desc);
     };
 
     std::mutex m_mtx{};
@@ -296,6 +395,10 @@ struct ResourcePool : IResourcePool
     std::string m_vramSegment{};
     std::map<uint64_t, std::vector<TimestampedResource>> m_free{};
     std::map<uint64_t, std::vector<TimestampedResource>> m_allocated{};
+    ResourcePoolEvictionPolicy m_policy{};
+    ResourcePoolStats m_stats{};
+    uint64_t m_pendingEvictionBytes{};
+    uint32_t m_pendingEvictionCount{};
 };
 
 ComputeStatus Generic::genericPostInit()
@@ -308,6 +411,7 @@ ComputeStatus Generic::init(Device device, param::IParameters* params)
 {
     m_parameters = params;
     m_typelessDevice = device;
+    internVRAMSegment(kGlobalVRAMSegment);
     params->get(sl::param::global::kPreferenceFlags, (uint64_t*)&m_preferenceFlags);
     return ComputeStatus::eOk;
 }
@@ -328,7 +432,13 @@ ComputeStatus Generic::shutdown()
 
     CHI_CHECK(collectGarbage(UINT_MAX));
     SL_LOG_INFO("Delayed destroy resource list count %llu", m_resourcesToDestroy.size());
-    m_vramSegments.clear();
+    // Names stay interned, ids could still be cached by threads
+    for (auto& seg : m_vramSegments)
+    {
+        seg.allocCount.store(0);
+        seg.totalAllocatedSize.store(0);
+        seg.peakAllocatedSize.store(0);
+    }
 
     return ComputeStatus::eOk;
 }
@@ -336,16 +446,17 @@ ComputeStatus Generic::shutdown()
 ComputeStatus Generic::clearCache()
 {
     // Release shared resources
-    for (auto& [original, shared] : m_sharedResourceMap)
+    std::scoped_lock lock(m_mutexSharedResource);
+    for (auto& entry : m_sharedResourceCache)
     {
-        if (shared.source != shared.translated)
+        if (entry.native)
         {
-            destroySharedHandle(shared.handle);
-            destroyResource(shared.translated);
-            destroyResource(shared.clone);
+            retireSharedResource(entry, false);
+            entry = {};
         }
     }
-    m_sharedResourceMap.clear();
+    m_sharedResourceCount = 0;
+    trimSharedResourceClones(true);
     return ComputeStatus::eOk;
 }
 
@@ -446,7 +557,7 @@ void Generic::setResourceTracked(chi::Resource resource, uint64_t tracked)
     }
 }
 
-bool Generic::isResourceTracked(chi::Resource resource)
+uint64_t Generic::getResourceTracked(chi::Resource resource)
 {
     uint64_t tracked = 0;
     assert(m_platform != RenderAPI::eVulkan);
@@ -458,7 +569,8 @@ bool Generic::isResourceTracked(chi::Resource resource)
         if (pageable)
         {
             UINT size = sizeof(tracked);
-            if (FAILED(pageable->GetPrivateData(sResourceTrackGUID, &size, &tracked)))
+            auto hr = pageable->GetPrivateData(sResourceTrackGUID, &size, &tracked);
+            if (FAILED(hr) && hr != DXGI_ERROR_NOT_FOUND)
             {
                 SL_LOG_ERROR("Failed to get tracked for resource 0x%llx", resource);
             }
@@ -471,7 +583,8 @@ bool Generic::isResourceTracked(chi::Resource resource)
             if (d3d11Resource)
             {
                 UINT size = sizeof(tracked);
-                if (FAILED(d3d11Resource->GetPrivateData(sResourceTrackGUID, &size, &tracked)))
+                auto hr = d3d11Resource->GetPrivateData(sResourceTrackGUID, &size, &tracked);
+                if (FAILED(hr) && hr != DXGI_ERROR_NOT_FOUND)
                 {
                     SL_LOG_ERROR("Failed to get tracked for resource 0x%llx", resource);
                 }
@@ -479,7 +592,7 @@ bool Generic::isResourceTracked(chi::Resource resource)
             }
         }
     }
-    return tracked == 1;
+    return tracked;
 }
 
 ComputeStatus Generic::getResourceState(Resource resource, ResourceState& state)
@@ -511,7 +624,8 @@ ComputeStatus Generic::transitionResources(CommandList cmdList, const ResourceTr
         return ComputeStatus::eOk;
     }
 
-    std::vector<ResourceTransition> transitionList;
+    std::pmr::vector<ResourceTransition> transitionList(extra::getFrameArena());
+    transitionList.reserve(count);
     for (uint32_t i = 0; i < count; i++)
     {
         auto tr = transitions[i];
@@ -542,9 +656,11 @@ ComputeStatus Generic::transitionResources(CommandList cmdList, const ResourceTr
 
     if (scopedTasks)
     {
+        // NOTE: Captured copy is allocated from the default resource since scoped tasks can outlive this frame
         auto lambda = [this, cmdList, transitionList](void) -> void
         {
-            std::vector<ResourceTransition> revTransitionList;
+            std::pmr::vector<ResourceTransition> revTransitionList(extra::getFrameArena());
+            revTransitionList.reserve(transitionList.size());
             for (auto& tr : transitionList)
             {
                 if (chi::ResourceState(tr.from & tr.to) & chi::ResourceState::eStorageRW)
@@ -562,91 +678,131 @@ ComputeStatus Generic::transitionResources(CommandList cmdList, const ResourceTr
     return transitionResourceImpl(cmdList, transitionList.data(), (uint32_t)transitionList.size());
 }
 
+//! Segment active on this thread, keyed by the owner so multiple compute instances in one module do not mix their ids
+struct CurrentVRAMSegment
+{
+    const Generic* owner;
+    uint32_t id;
+};
+thread_local CurrentVRAMSegment t_currentVRAMSegment{};
+
+uint32_t Generic::findVRAMSegment(const char* name) const
+{
+    auto count = m_vramSegmentCount.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (strncmp(m_vramSegments[i].name, name, kMaxVRAMSegmentNameLength - 1) == 0)
+        {
+            return i;
+        }
+    }
+    return UINT_MAX;
+}
+
+uint32_t Generic::internVRAMSegment(const char* name)
+{
+    auto id = findVRAMSegment(name);
+    if (id != UINT_MAX) return id;
+
+    std::scoped_lock lock(m_mutexVRAM);
+    // Someone else could have added it while we were waiting
+    id = findVRAMSegment(name);
+    if (id != UINT_MAX) return id;
+
+    id = m_vramSegmentCount.load();
+    if (id >= kMaxNumVRAMSegments)
+    {
+        SL_LOG_ERROR("Too many VRAM segments, '%s' will be accounted as '%s'", name, kGlobalVRAMSegment);
+        return 0;
+    }
+    // Name storage is zero initialized so it stays null terminated
+    memcpy(m_vramSegments[id].name, name, std::min(strlen(name), size_t(kMaxVRAMSegmentNameLength - 1)));
+    m_vramSegmentCount.store(id + 1, std::memory_order_release);
+    return id;
+}
+
 ComputeStatus Generic::beginVRAMSegment(const char* name)
 {
     if (!name) return ComputeStatus::eInvalidArgument;
-    std::scoped_lock lock(m_mutexVRAM);
-    auto& id = m_currentVRAMSegment[std::this_thread::get_id()];
-    assert(id.empty() || id == kGlobalVRAMSegment);
-    id = name;
+    auto& current = t_currentVRAMSegment;
+    assert(current.owner != this || current.id == 0);
+    current = { this, internVRAMSegment(name) };
     return ComputeStatus::eOk;
 }
 
 ComputeStatus Generic::endVRAMSegment()
 {
-    std::scoped_lock lock(m_mutexVRAM);
-    auto& id = m_currentVRAMSegment[std::this_thread::get_id()];
-    assert(!id.empty() && id != kGlobalVRAMSegment);
-    id = kGlobalVRAMSegment;
+    auto& current = t_currentVRAMSegment;
+    assert(current.owner == this && current.id != 0);
+    current = { this, 0 };
     return ComputeStatus::eOk;
 }
 
 ComputeStatus Generic::getAllocatedBytes(uint64_t& bytes, const char* name)
 { 
     bytes = {};
-    std::scoped_lock lock(m_mutexVRAM);
-    auto it = m_vramSegments.find(name);
-    if(it == m_vramSegments.end()) return ComputeStatus::eInvalidArgument;
-    auto& seg = (*it).second;
-    bytes = seg.totalAllocatedSize;
+    auto id = findVRAMSegment(name);
+    if (id == UINT_MAX) return ComputeStatus::eInvalidArgument;
+    bytes = m_vramSegments[id].totalAllocatedSize.load(std::memory_order_relaxed);
     return ComputeStatus::eOk; 
 }
 
-Generic::VRAMSegment Generic::manageVRAM(Resource res, VRAMOperation op)
+ComputeStatus Generic::getVRAMSegmentStats(VRAMSegmentStats* stats, uint32_t& count)
 {
-    ResourceDescription desc;
-    getResourceDescription(res, desc);
-    auto sizeInBytes = getResourceSize(res);
-    auto name = getDebugName(res);
-
-    std::scoped_lock lock(m_mutexVRAM);
-
-    auto& id = m_currentVRAMSegment[std::this_thread::get_id()];
-    if (id != kGlobalVRAMSegment)
+    auto numSegments = m_vramSegmentCount.load(std::memory_order_acquire);
+    if (stats)
     {
-        auto& seg = m_vramSegments[id];
-        if (op == VRAMOperation::eFree)
+        for (uint32_t i = 0; i < std::min(count, numSegments); i++)
         {
-            if (seg.allocCount == 0 || seg.totalAllocatedSize < sizeInBytes)
-            {
-                seg = {};
-            }
-            else
-            {
-                seg.allocCount--;
-                seg.totalAllocatedSize -= sizeInBytes;
-            }
+            auto& seg = m_vramSegments[i];
+            stats[i] = { seg.name, seg.allocCount.load(std::memory_order_relaxed), seg.totalAllocatedSize.load(std::memory_order_relaxed), seg.peakAllocatedSize.load(std::memory_order_relaxed) };
         }
-        else
-        {
-            seg.allocCount++;
-            seg.totalAllocatedSize += sizeInBytes;
-        }
-        
-        SL_LOG_VERBOSE("vram %s [%s %u %.1fMB usage:%.2fGB budget:%.2fGB] resource 0x%llx [%u:%u:%s] - '%S'", op == VRAMOperation::eFree ? "free" : "alloc", id.c_str(), seg.allocCount, 
-            double(seg.totalAllocatedSize / (1024 * 1024)), double(m_vramUsageBytes.load() / (1024 * 1024 * 1024)), double(m_vramBudgetBytes.load() / (1024 * 1024 * 1024)),
-            res->native, desc.width, desc.height, GFORMAT_STR[desc.format], name.c_str());
     }
+    count = numSegments;
+    return ComputeStatus::eOk;
+}
+
+namespace
+{
+//! Counters never go below zero, mismatched frees reset the segment like before
+inline void subtractClamped(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    auto current = counter.load(std::memory_order_relaxed);
+    while (!counter.compare_exchange_weak(current, current >= value ? current - value : 0, std::memory_order_relaxed)) {}
+}
 
-    auto& seg = m_vramSegments[kGlobalVRAMSegment];
+inline void updateVRAMSegment(std::atomic<uint64_t>& allocCount, std::atomic<uint64_t>& totalAllocatedSize, std::atomic<uint64_t>& peakAllocatedSize, uint64_t sizeInBytes, VRAMOperation op)
+{
     if (op == VRAMOperation::eFree)
     {
-        if (seg.allocCount == 0 || seg.totalAllocatedSize < sizeInBytes)
-        {
-            seg = {};
-        }
-        else
-        {
-            seg.allocCount--;
-            seg.totalAllocatedSize -= sizeInBytes;
-        }
+        subtractClamped(allocCount, 1);
+        subtractClamped(totalAllocatedSize, sizeInBytes);
     }
     else
     {
-        seg.allocCount++;
-        seg.totalAllocatedSize += sizeInBytes;
+        allocCount.fetch_add(1, std::memory_order_relaxed);
+        auto total = totalAllocatedSize.fetch_add(sizeInBytes, std::memory_order_relaxed) + sizeInBytes;
+        auto peak = peakAllocatedSize.load(std::memory_order_relaxed);
+        while (total > peak && !peakAllocatedSize.compare_exchange_weak(peak, total, std::memory_order_relaxed)) {}
+    }
+}
+}
+
+void Generic::manageVRAM(Resource res, VRAMOperation op)
+{
+    auto sizeInBytes = getResourceSize(res);
+
+    auto& current = t_currentVRAMSegment;
+    uint32_t id = current.owner == this ? current.id : 0;
+
+    auto& seg = m_vramSegments[id];
+    auto& global = m_vramSegments[0];
+    updateVRAMSegment(global.allocCount, global.totalAllocatedSize, global.peakAllocatedSize, sizeInBytes, op);
+    if (id != 0)
+    {
+        updateVRAMSegment(seg.allocCount, seg.totalAllocatedSize, seg.peakAllocatedSize, sizeInBytes, op);
     }
-    
+
     // Warn if global allocations are over the budget
     auto budgetedBytes = m_vramBudgetBytes.load();
     auto usedBytes = m_vramUsageBytes.load();
@@ -655,13 +811,16 @@ Generic::VRAMSegment Generic::manageVRAM(Resource res, VRAMOperation op)
         SL_LOG_WARN("Allocated %.2fMB which is more than allowed by the VRAM budget %.2fMB", usedBytes / (1024.0 * 1024.0), budgetedBytes / (1024.0 * 1024.0));
     }
 
-    if (id == kGlobalVRAMSegment)
+    // Description and debug name are not free to obtain so only do it when they are actually going to be logged
+    if (log::getInterface()->getLogLevel() == LogLevel::eVerbose)
     {
-        SL_LOG_VERBOSE("vram %s [%s %u %.1fMB usage:%.2fGB budget:%.2fGB] resource 0x%llx [%u:%u:%s] - '%S'", op == VRAMOperation::eFree ? "free" : "alloc", id.c_str(), seg.allocCount,
-            double(seg.totalAllocatedSize / (1024 * 1024)), double(m_vramUsageBytes.load() / (1024 * 1024 * 1024)), double(m_vramBudgetBytes.load() / (1024 * 1024 * 1024)),
+        ResourceDescription desc;
+        getResourceDescription(res, desc);
+        auto name = getDebugName(res);
+        SL_LOG_VERBOSE("vram %s [%s %llu %.1fMB usage:%.2fGB budget:%.2fGB] resource 0x%llx [%u:%u:%s] - '%S'", op == VRAMOperation::eFree ? "free" : "alloc", seg.name, seg.allocCount.load(),
+            double(seg.totalAllocatedSize.load() / (1024 * 1024)), double(m_vramUsageBytes.load() / (1024 * 1024 * 1024)), double(m_vramBudgetBytes.load() / (1024 * 1024 * 1024)),
             res->native, desc.width, desc.height, GFORMAT_STR[desc.format], name.c_str());
     }
-    return seg;
 }
 
 ComputeStatus Generic::createBuffer(const ResourceDescription& CreateResourceDesc, Resource& OutResource, const char InFriendlyName[])
@@ -785,6 +944,11 @@ ComputeStatus Generic::collectGarbage(uint32_t finishedFrame)
         m_finishedFrame.store(finishedFrame);
     }
 
+    {
+        std::scoped_lock lock(m_mutexSharedResource);
+        trimSharedResourceClones(finishedFrame == UINT_MAX);
+    }
+
     std::lock_guard<std::mutex> lock(m_mutexResource);
 
     {
@@ -1187,6 +1351,70 @@ bool Generic::savePFM(const std::string &path, const char* srcBuffer, const int
 //    return ComputeStatus::eOk;
 //}
 //
+inline uint32_t getSharedResourceSlot(void* native)
+{
+    return uint32_t(((uint64_t)native * 0x9e3779b97f4a7c15ull) >> 32) & (kSharedResourceCacheSize - 1);
+}
+
+void Generic::retireSharedResource(SharedResourceEntry& entry, bool reuseClone)
+{
+    auto& shared = entry.shared;
+    if (shared.clone && reuseClone)
+    {
+        // Handle and translated resource were created from the clone so they stay with it
+        m_sharedResourceClones.push_back({ entry.descHash, entry.desc, m_finishedFrame.load(), entry.otherAPI, shared });
+        trimSharedResourceClones(false);
+        return;
+    }
+    // Regular delayed destroy since the last frame or two could still be using these
+    destroySharedHandle(shared.handle);
+    destroyResource(shared.translated);
+    if (shared.clone)
+    {
+        entry.otherAPI->destroyResource(shared.clone);
+    }
+}
+
+void Generic::eraseSharedResource(uint32_t slot)
+{
+    // Backward shift deletion, no tombstones so lookups never have to skip over dead slots
+    m_sharedResourceCache[slot] = {};
+    m_sharedResourceCount--;
+    auto hole = slot;
+    auto next = (slot + 1) & (kSharedResourceCacheSize - 1);
+    while (m_sharedResourceCache[next].native)
+    {
+        auto home = getSharedResourceSlot(m_sharedResourceCache[next].native);
+        // Entry can move into the hole only if the hole is on its probe path
+        if (((next - home) & (kSharedResourceCacheSize - 1)) >= ((next - hole) & (kSharedResourceCacheSize - 1)))
+        {
+            m_sharedResourceCache[hole] = m_sharedResourceCache[next];
+            m_sharedResourceCache[next] = {};
+            hole = next;
+        }
+        next = (next + 1) & (kSharedResourceCacheSize - 1);
+    }
+}
+
+void Generic::trimSharedResourceClones(bool force)
+{
+    auto finishedFrame = m_finishedFrame.load();
+    auto it = m_sharedResourceClones.begin();
+    while (it != m_sharedResourceClones.end())
+    {
+        if (force || finishedFrame > (*it).frame + kSharedResourceCloneLifetime || m_sharedResourceClones.size() > kMaxNumSharedResourceClones)
+        {
+            auto& shared = (*it).shared;
+            destroySharedHandle(shared.handle);
+            destroyResource(shared.translated);
+            (*it).otherAPI->destroyResource(shared.clone);
+            it = m_sharedResourceClones.erase(it);
+            continue;
+        }
+        it++;
+    }
+}
+
 ComputeStatus Generic::fetchTranslatedResourceFromCache(ICompute* compute, ResourceType type, Resource resource, TranslatedResource& shared, const char friendlyName[])
 {
     if (!compute || !resource || !resource->native)
@@ -1199,44 +1427,97 @@ ComputeStatus Generic::fetchTranslatedResourceFromCache(ICompute* compute, Resou
 
     auto otherAPI = (Generic*)compute;
 
-    auto it = m_sharedResourceMap.find(resource->native);
-    // If resource is cached and it is a texture not a fence or semaphore check for recycled pointers
-    if (type == ResourceType::eTex2d && it != m_sharedResourceMap.end())
+    uint64_t generation = 0;
+    if (type == ResourceType::eTex2d)
+    {
+        // Zero if we have never seen this resource, recycled pointer is a brand new resource without our private data
+        generation = getResourceTracked(resource);
+    }
+    else if (type != ResourceType::eFence)
     {
-        if (!isResourceTracked(resource))
+        SL_LOG_ERROR( "Only semaphores and tex2d objects can be shared");
+        return ComputeStatus::eInvalidArgument;
+    }
+
+    std::scoped_lock lock(m_mutexSharedResource);
+
+    auto slot = getSharedResourceSlot(resource->native);
+    while (m_sharedResourceCache[slot].native)
+    {
+        auto& entry = m_sharedResourceCache[slot];
+        if (entry.native == resource->native)
         {
-            // Pointer recycled by DX, remove from cache
+            if (entry.generation == generation)
+            {
+                entry.lastUsedFrame = m_finishedFrame.load();
+                shared.translated = entry.shared.translated;
+                shared.handle = entry.shared.handle;
+                shared.clone = entry.shared.clone;
+                shared.source = resource;
+                return ComputeStatus::eOk;
+            }
+            // Pointer recycled by DX, slot is refilled by the shift so check it again
             SL_LOG_WARN("Detected recycled resource 0x%llx - removing from the shared resource cache", resource);
-
-            auto& shared = (*it).second;
-            destroySharedHandle(shared.handle);
-            destroyResource(shared.translated);
-            otherAPI->destroyResource(shared.clone);
-            m_sharedResourceMap.erase(it);
-            it = m_sharedResourceMap.end();
+            retireSharedResource(entry, true);
+            eraseSharedResource(slot);
+            continue;
         }
+        slot = (slot + 1) & (kSharedResourceCacheSize - 1);
     }
-    if (it == m_sharedResourceMap.end())
+
+    if (m_sharedResourceCount >= kMaxNumSharedResources)
     {
-        chi::ResourceDescription desc{};
-        if (type == ResourceType::eTex2d)
+        uint32_t lru = 0;
+        for (uint32_t i = 1; i < kSharedResourceCacheSize; i++)
         {
-            otherAPI->getResourceDescription(resource, desc);
-        }
-        else if (type == ResourceType::eFence)
-        {
-            // All semaphores created internally are shareable by default
-            desc.flags = chi::ResourceFlags::eSharedResource;
+            if (!m_sharedResourceCache[lru].native || (m_sharedResourceCache[i].native && m_sharedResourceCache[i].lastUsedFrame < m_sharedResourceCache[lru].lastUsedFrame))
+            {
+                lru = i;
+            }
         }
-        else
+        retireSharedResource(m_sharedResourceCache[lru], true);
+        eraseSharedResource(lru);
+        // Shift could have moved entries around, find the end of our probe run again
+        slot = getSharedResourceSlot(resource->native);
+        while (m_sharedResourceCache[slot].native)
         {
-            SL_LOG_ERROR( "Only semaphores and tex2d objects can be shared");
-            return ComputeStatus::eInvalidArgument;
+            slot = (slot + 1) & (kSharedResourceCacheSize - 1);
         }
+    }
 
-        if ((desc.flags & chi::ResourceFlags::eSharedResource))
+    // Miss, only now we need the description
+    chi::ResourceDescription desc{};
+    uint64_t descHash = 0;
+    if (type == ResourceType::eTex2d)
+    {
+        otherAPI->getResourceDescription(resource, desc);
+        descHash = getResourceDescriptionHash(desc);
+    }
+    else
+    {
+        // All semaphores created internally are shareable by default
+        desc.flags = chi::ResourceFlags::eSharedResource;
+    }
+
+    shared = {};
+    if ((desc.flags & chi::ResourceFlags::eSharedResource))
+    {
+        CHI_VALIDATE(otherAPI->createSharedHandle(resource, shared.handle));
+        CHI_VALIDATE(getResourceFromSharedHandle(type, shared.handle, shared.translated));
+    }
+    else
+    {
+        auto it = std::find_if(m_sharedResourceClones.begin(), m_sharedResourceClones.end(), [&desc, descHash, otherAPI, this](const SharedResourceClone& clone)->bool
+        {
+            // Hash first, then the actual description so a collision never hands out a clone of the wrong size or format
+            return clone.descHash == descHash && clone.otherAPI == otherAPI && m_finishedFrame.load() > clone.frame + kSharedResourceCloneReuseDelay &&
+                clone.desc.width == desc.width && clone.desc.height == desc.height && clone.desc.format == desc.format &&
+                clone.desc.nativeFormat == desc.nativeFormat && clone.desc.mips == desc.mips && clone.desc.depth == desc.depth && clone.desc.flags == desc.flags;
+        });
+        if (it != m_sharedResourceClones.end())
         {
-            CHI_VALIDATE(otherAPI->createSharedHandle(resource, shared.handle));
+            shared = (*it).shared;
+            m_sharedResourceClones.erase(it);
         }
         else
         {
@@ -1247,26 +1528,33 @@ ComputeStatus Generic::fetchTranslatedResourceFromCache(ICompute* compute, Resou
             {
                 SL_LOG_WARN("Tagged d3d11 resources 0x%llx should be created with the 'D3D11_RESOURCE_MISC_SHARED_NTHANDLE' flag to avoid additional copies", resource);
             }
-            desc.flags |= chi::ResourceFlags::eSharedResource;
+            // Entry keeps the source description so parked clones match the next lookup
+            auto cloneDesc = desc;
+            cloneDesc.flags |= chi::ResourceFlags::eSharedResource;
             std::string name = friendlyName + std::string(".clone");
-            CHI_VALIDATE(otherAPI->createTexture2D(desc, shared.clone, name.c_str()));
+            CHI_VALIDATE(otherAPI->createTexture2D(cloneDesc, shared.clone, name.c_str()));
             CHI_VALIDATE(otherAPI->createSharedHandle(shared.clone, shared.handle));
-        }
-        CHI_VALIDATE(getResourceFromSharedHandle(type, shared.handle, shared.translated));
-
-        m_sharedResourceMap[resource->native] = shared;
-        if (type == ResourceType::eTex2d)
-        {
-            // Mark for tracking so we can detect recycled pointers
-            setResourceTracked(resource, 1);
+            CHI_VALIDATE(getResourceFromSharedHandle(type, shared.handle, shared.translated));
         }
     }
-    else
+
+    if (type == ResourceType::eTex2d && !generation)
     {
-        shared.translated = (*it).second.translated;
-        shared.handle = (*it).second.handle;
-        shared.clone = (*it).second.clone;
+        // Stamp the resource so we can detect recycled pointers
+        generation = ++m_sharedResourceGeneration;
+        setResourceTracked(resource, generation);
     }
+
+    auto& entry = m_sharedResourceCache[slot];
+    entry.native = resource->native;
+    entry.generation = generation;
+    entry.descHash = descHash;
+    entry.desc = desc;
+    entry.lastUsedFrame = m_finishedFrame.load();
+    entry.otherAPI = otherAPI;
+    entry.shared = shared;
+    m_sharedResourceCount++;
+
     shared.source = resource;
     return ComputeStatus::eOk;
 }
@@ -58,6 +58,29 @@ inline void hash_combine(std::size_t & s, const T & v)
     s ^= h(v) + 0x9e3779b9 + (s << 6) + (s >> 2);
 }
 
+//! Slots in the shared resource cache, must be a power of two
+constexpr uint32_t kSharedResourceCacheSize = 256;
+//! Least recently used entries are retired past this point, also keeps the probe runs short
+constexpr uint32_t kMaxNumSharedResources = 192;
+//! Clones which are no longer referenced are kept for reuse up to this many frames
+constexpr uint32_t kSharedResourceCloneLifetime = 120;
+constexpr uint32_t kMaxNumSharedResourceClones = 8;
+//! Same as the default 'destroyResource' delay, clone is not reused while GPU could still be copying into it
+constexpr uint32_t kSharedResourceCloneReuseDelay = 3;
+
+inline uint64_t getResourceDescriptionHash(const ResourceDescription& desc)
+{
+    size_t hash = 0;
+    hash_combine(hash, desc.width);
+    hash_combine(hash, desc.height);
+    hash_combine(hash, desc.format);
+    hash_combine(hash, desc.mips);
+    hash_combine(hash, desc.depth);
+    hash_combine(hash, desc.flags);
+    hash_combine(hash, desc.state);
+    return hash;
+}
+
 struct KernelDataBase
 {
     size_t hash = {};
@@ -142,15 +165,56 @@ protected:
     bool m_bFastUAVClearSupported = false;
     PreferenceFlags m_preferenceFlags{};
 
+    //! Segment names are interned once, counters are updated without locking
+    //!
+    //! Id 0 is the global segment, name is written before the segment count is bumped so readers never see a partial entry.
     struct VRAMSegment
     {
-        uint64_t allocCount{};
-        uint64_t totalAllocatedSize{};
+        char name[kMaxVRAMSegmentNameLength]{};
+        std::atomic<uint64_t> allocCount{};
+        std::atomic<uint64_t> totalAllocatedSize{};
+        std::atomic<uint64_t> peakAllocatedSize{};
+    };
+    VRAMSegment m_vramSegments[kMaxNumVRAMSegments]{};
+    std::atomic<uint32_t> m_vramSegmentCount{};
+
+    uint32_t findVRAMSegment(const char* name) const;
+    uint32_t internVRAMSegment(const char* name);
+
+    //! Translated resources are keyed by native pointer and generation stamped on the resource when first seen so
+    //! recycled pointers never hit a stale entry. D3D resource descriptions are immutable so the description is
+    //! queried once on a miss and kept in the entry, hits only read the generation back.
+    //!
+    //! Open addressing with linear probing, slot is derived from the native pointer only so every entry for
+    //! the same pointer sits in one probe run and stale ones are retired as soon as the pointer shows up again.
+    struct SharedResourceEntry
+    {
+        void* native{};
+        uint64_t generation{};
+        uint64_t descHash{};
+        ResourceDescription desc{};
+        uint32_t lastUsedFrame{};
+        ICompute* otherAPI{};
+        TranslatedResource shared{};
     };
-    std::map<std::string, VRAMSegment> m_vramSegments{};
-    std::map<std::thread::id, std::string> m_currentVRAMSegment{};
+    //! Clone of a non-shareable resource which is no longer referenced, can be reused for any resource with the same description
+    struct SharedResourceClone
+    {
+        uint64_t descHash{};
+        ResourceDescription desc{};
+        uint32_t frame{};
+        ICompute* otherAPI{};
+        TranslatedResource shared{};
+    };
+    std::mutex m_mutexSharedResource;
+    SharedResourceEntry m_sharedResourceCache[kSharedResourceCacheSize]{};
+    uint32_t m_sharedResourceCount{};
+    uint64_t m_sharedResourceGeneration{};
+    std::vector<SharedResourceClone> m_sharedResourceClones{};
 
-    std::map<void*, TranslatedResource> m_sharedResourceMap{};
+    void retireSharedResource(SharedResourceEntry& entry, bool reuseClone);
+    void eraseSharedResource(uint32_t slot);
+    void trimSharedResourceClones(bool force);
 
     virtual int destroyResourceDeferredImpl(const Resource InResource) = 0;
     virtual ComputeStatus createBufferResourceImpl(ResourceDescription &InOutResourceDesc, Resource &OutResource, ResourceState InitialState) = 0;
@@ -161,6 +225,7 @@ protected:
     virtual ComputeStatus beginVRAMSegment(const char* name) override final;
     virtual ComputeStatus endVRAMSegment() override final;
     virtual ComputeStatus getAllocatedBytes(uint64_t& bytes, const char* name = kGlobalVRAMSegment) override;
+    virtual ComputeStatus getVRAMSegmentStats(VRAMSegmentStats* stats, uint32_t& count) override final;
 
     virtual std::wstring getDebugName(Resource res) = 0;
 
@@ -171,9 +236,9 @@ protected:
     uint64_t getResourceSize(Resource res);
 
     void setResourceTracked(chi::Resource resource, uint64_t tracked);
-    bool isResourceTracked(chi::Resource resource);
+    uint64_t getResourceTracked(chi::Resource resource);
 
-    VRAMSegment manageVRAM(Resource res, VRAMOperation op);
+    void manageVRAM(Resource res, VRAMOperation op);
 
 public:
     // Function Below Is MooreThreads Added Begin
@@ -237,6 +302,12 @@ public:
         totalBytes = m_vramBudgetBytes.load() > m_vramUsageBytes.load() ? m_vramBudgetBytes.load() - m_vramUsageBytes.load() : 0; 
         return ComputeStatus::eOk; 
     }
+    virtual ComputeStatus getVRAMUsage(uint64_t& currentUsageBytes, uint64_t& budgetBytes) override final
+    {
+        budgetBytes = m_vramBudgetBytes.load();
+        currentUsageBytes = m_vramUsageBytes.load();
+        return budgetBytes == 0 ? ComputeStatus::eNotReady : ComputeStatus::eOk;
+    }
 
     virtual ComputeStatus collectGarbage(uint32_t frame);
 
@@ -256,6 +327,7 @@ public:
     virtual ComputeStatus stopTrackingResource(uint32_t id) override;
 
     ComputeStatus restorePipeline(CommandList cmdList)  override { return ComputeStatus::eOk; }
+    ComputeStatus invalidatePipeline(CommandList cmdList)  override { return ComputeStatus::eOk; }
 
     ComputeStatus transitionResources(CommandList cmdList, const ResourceTransition* transitions, uint32_t count, extra::ScopedTasks* tasks = nullptr) override;
     ComputeStatus getResourceState(Resource resource, ResourceState& state) override;
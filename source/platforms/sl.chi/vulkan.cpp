@@ -61,7 +61,7 @@ class CommandListContextVK : public ICommandListContext
     };
     std::vector<WaitInfo> m_waitingQueue;
 
-    VkLayerDispatchTable m_ddt;
+    VkLayerDispatchTable m_ddt{};
     interposer::VkTable* m_vk;
 
     ICompute* m_compute = {};
@@ -88,12 +88,18 @@ class CommandListContextVK : public ICommandListContext
 
 public:
 
-    void init(ICompute* c, interposer::VkTable* vkMap, const char* debugName, VkDevice dev, CommandQueueVk* queue, uint32_t count)
+    bool init(ICompute* c, interposer::VkTable* vkMap, const char* debugName, VkDevice dev, CommandQueueVk* queue, uint32_t count)
     {
         m_compute = c;
         m_device = dev;
         m_vk = vkMap;
-        m_ddt = m_vk->dispatchDeviceMap[dev];
+        auto ddt = m_vk->dispatchDeviceMap.get(dev);
+        if (!ddt)
+        {
+            SL_LOG_ERROR("Unable to find dispatch table for device 0x%llx", dev);
+            return false;
+        }
+        m_ddt = *ddt;
         m_name = extra::utf8ToUtf16(debugName);
         m_cmdQueue = (VkQueue)queue->native;
         m_bufferCount = count;
@@ -108,8 +114,8 @@ public:
         createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
         createInfo.pNext = {};
         createInfo.flags = 0;
-        VK_CHECK_RV(m_ddt.CreateSemaphore(dev, &createInfo, NULL, &m_presentSemaphore));
-        VK_CHECK_RV(m_ddt.CreateSemaphore(dev, &createInfo, NULL, &m_acquireSemaphore));
+        VK_CHECK_RF(m_ddt.CreateSemaphore(dev, &createInfo, NULL, &m_presentSemaphore));
+        VK_CHECK_RF(m_ddt.CreateSemaphore(dev, &createInfo, NULL, &m_acquireSemaphore));
 
         sl::Resource r;
         r.native = m_presentSemaphore;
@@ -136,7 +142,7 @@ public:
                 createInfo.pNext = &timelineCreateInfo;
                 createInfo.flags = 0;
 
-                VK_CHECK_RV(m_ddt.CreateSemaphore(dev, &createInfo, NULL, &m_fence[i]));
+                VK_CHECK_RF(m_ddt.CreateSemaphore(dev, &createInfo, NULL, &m_fence[i]));
 
                 m_fenceValue[i] = 0;
 
@@ -147,7 +153,7 @@ public:
             }
             {
                 const VkCommandPoolCreateInfo createInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, nullptr, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, queue->family };
-                VK_CHECK_RV(m_ddt.CreateCommandPool(m_device, &createInfo, nullptr, &m_allocator[i]));
+                VK_CHECK_RF(m_ddt.CreateCommandPool(m_device, &createInfo, nullptr, &m_allocator[i]));
                 sl::Resource r;
                 r.native = m_allocator[i];
                 r.type = (ResourceType)ResourceType::eCommandPool;
@@ -159,23 +165,28 @@ public:
                     VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, nullptr,
                     m_allocator[i], VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1
                 };
-                VK_CHECK_RV(m_ddt.AllocateCommandBuffers(m_device, &allocInfo, &m_cmdBuffer[i]));
+                VK_CHECK_RF(m_ddt.AllocateCommandBuffers(m_device, &allocInfo, &m_cmdBuffer[i]));
                 sl::Resource r;
                 r.native = m_cmdBuffer[i];
                 r.type = (ResourceType)ResourceType::eCommandBuffer;
                 m_compute->setDebugName(&r, (std::string(debugName) + "_command_buffer").c_str());
             }
         }
-        
+        return true;
     }
 
     void shutdown()
     {
+        // Init could have failed part way through, null handles are fine for the destroy calls
+        if (!m_ddt.DestroySemaphore) return;
         m_ddt.DestroySemaphore(m_device, m_presentSemaphore, nullptr);
         m_ddt.DestroySemaphore(m_device, m_acquireSemaphore, nullptr);
         for (uint32_t i = 0; i < 2 * m_bufferCount; i++)
         {
-            m_ddt.FreeCommandBuffers(m_device, m_allocator[i], 1, &m_cmdBuffer[i]);
+            if (m_cmdBuffer[i])
+            {
+                m_ddt.FreeCommandBuffers(m_device, m_allocator[i], 1, &m_cmdBuffer[i]);
+            }
             m_ddt.DestroyCommandPool(m_device, m_allocator[i], nullptr);
             m_ddt.DestroySemaphore(m_device, m_fence[i], nullptr);
         }
@@ -892,8 +903,15 @@ ComputeStatus Vulkan::init(Device device, param::IParameters* params)
     m_vk->opticalFlowQueueIndex = vk->opticalFlowQueueIndex;
     m_vk->mapVulkanInstanceAPI(m_instance);
     m_vk->mapVulkanDeviceAPI(m_device);
-    m_ddt = m_vk->dispatchDeviceMap[m_device];
-    m_idt = m_vk->dispatchInstanceMap[m_instance];
+    auto ddt = m_vk->dispatchDeviceMap.get(m_device);
+    auto idt = m_vk->dispatchInstanceMap.get(m_instance);
+    if (!ddt || !idt)
+    {
+        SL_LOG_ERROR("Unable to find dispatch table for device 0x%llx or instance 0x%llx", m_device, m_instance);
+        return ComputeStatus::eError;
+    }
+    m_ddt = *ddt;
+    m_idt = *idt;
 
     if(m_idt.CreateDebugUtilsMessengerEXT)
     {
@@ -1209,7 +1227,12 @@ ComputeStatus Vulkan::destroyKernel(Kernel& kernel)
 ComputeStatus Vulkan::createCommandListContext(CommandQueue queue, uint32_t count, ICommandListContext*& ctx, const char friendlyName[])
 { 
     auto tmp = new CommandListContextVK();
-    tmp->init(this, m_vk, friendlyName, m_device, (CommandQueueVk*)queue, count);
+    if (!tmp->init(this, m_vk, friendlyName, m_device, (CommandQueueVk*)queue, count))
+    {
+        tmp->shutdown();
+        delete tmp;
+        return ComputeStatus::eError;
+    }
     ctx = tmp;
     return ComputeStatus::eOk;
 }
@@ -34,6 +34,7 @@
 #include "source/core/sl.file/file.h"
 #include "source/core/sl.plugin/plugin.h"
 #include "source/core/sl.param/parameters.h"
+#include "source/core/sl.extra/arena.h"
 #include "source/core/sl.interposer/d3d12/d3d12.h"
 #include "source/core/sl.interposer/vulkan/layer.h"
 #include "source/plugins/sl.common/versions.h"
@@ -213,7 +214,7 @@ void getCommonTag(BufferType tagType, uint32_t id, CommonResource& res, const sl
     //! First look for local tags
     if (inputs)
     {
-        std::vector<ResourceTag*> tags;
+        std::pmr::vector<ResourceTag*> tags(extra::getFrameArena());
         if (findStructs<ResourceTag>((const void**)inputs, numInputs, tags))
         {
             for (auto& tag : tags)
@@ -440,6 +441,12 @@ common::GetDataResult getCommonConstants(const common::EventData& ev, Constants*
 
 sl::Result slEvaluateFeature(sl::Feature feature, const sl::FrameToken& frame, const sl::BaseStructure** inputs, uint32_t numInputs, sl::CommandBuffer* cmdBuffer)
 {
+    // Per call temporaries come from the thread's frame arena, anything left over from the previous frame is reclaimed here
+    if (!extra::getFrameArena()->beginFrame(frame))
+    {
+        SL_LOG_WARN_ONCE("Frame arena allocations outlived frame %u, arena will be reset once they are released", (uint32_t)frame);
+    }
+
     // Check if host provided tags or constants in the eval call
 
     auto viewport = findStruct<ViewportHandle>((const void**)inputs, numInputs);
@@ -452,7 +459,7 @@ sl::Result slEvaluateFeature(sl::Feature feature, const sl::FrameToken& frame, c
     //! Look for local tags that won't be valid later on
     if (inputs)
     {
-        std::vector<ResourceTag*> tags;
+        std::pmr::vector<ResourceTag*> tags(extra::getFrameArena());
         if (findStructs<ResourceTag>((const void**)inputs, numInputs, tags))
         {
             for (auto& tag : tags)
@@ -490,6 +497,8 @@ bool createNGXFeature(void* cmdList, NVSDK_NGX_Feature feature, NVSDK_NGX_Handle
     }
     else if (ctx.platform == RenderAPI::eD3D12)
     {
+        // NGX binds its own pipeline state
+        ctx.compute->invalidatePipeline(cmdList);
         CHECK_NGX_RETURN_ON_ERROR(NVSDK_NGX_D3D12_CreateFeature((ID3D12GraphicsCommandList*)cmdList, feature, ctx.ngxContext.params, handle));
     }
     else
@@ -511,6 +520,7 @@ bool evaluateNGXFeature(void* cmdList, NVSDK_NGX_Handle* handle, const char* id)
     }
     else if (ctx.platform == RenderAPI::eD3D12)
     {
+        ctx.compute->invalidatePipeline(cmdList);
         CHECK_NGX_RETURN_ON_ERROR(NVSDK_NGX_D3D12_EvaluateFeature((ID3D12GraphicsCommandList*)cmdList, handle, ctx.ngxContext.params, nullptr));
     }
     else
@@ -550,17 +560,11 @@ void updateNGXFeature(NVSDK_NGX_Feature feature)
     if (preferenceFlags & PreferenceFlags::eAllowOTA)
     {
         //! Plugin manager gives us the device type and the application id
-        json& config = *(json*)api::getContext()->loaderConfig;
-        int appId = config.at("appId");
-        EngineType engineType{};
-        std::string engineVersion{};
-        std::string projectId{};
-        if (config.contains("ngx"))
-        {
-            engineType = config.at("ngx").at("engineType");
-            engineVersion = config.at("ngx").at("engineVersion");
-            projectId = config.at("ngx").at("projectId");
-        }
+        auto& config = api::getContext()->loaderConfig;
+        int appId = config.getAppId();
+        EngineType engineType = config.getEngineType();
+        std::string engineVersion = config.getEngineVersion();
+        std::string projectId = config.getProjectId();
 
         NVSDK_NGX_Application_Identifier applicationId;
         if (projectId.empty() && engineVersion.empty())
@@ -600,18 +604,12 @@ bool getNGXFeatureRequirements(NVSDK_NGX_Feature feature, common::PluginInfo& pl
             auto adapter = (IDXGIAdapter*)ctx.caps->adapters[i].nativeInterface;
 
             //! Plugin manager gives us the info we need
-            json& config = *(json*)api::getContext()->loaderConfig;
-            int appId = config.at("appId");
-            RenderAPI deviceType = (RenderAPI)config.at("deviceType");
-            EngineType engineType{};
-            std::string engineVersion{};
-            std::string projectId{};
-            if (config.contains("ngx"))
-            {
-                engineType = config.at("ngx").at("engineType");
-                engineVersion = config.at("ngx").at("engineVersion");
-                projectId = config.at("ngx").at("projectId");
-            }
+            auto& config = api::getContext()->loaderConfig;
+            int appId = config.getAppId();
+            RenderAPI deviceType = config.getDeviceType();
+            EngineType engineType = config.getEngineType();
+            std::string engineVersion = config.getEngineVersion();
+            std::string projectId = config.getProjectId();
 
             NVSDK_NGX_Application_Identifier applicationId;
             if (projectId.empty() && engineVersion.empty())
@@ -1044,20 +1042,12 @@ bool slOnPluginStartup(const char* jsonConfig, void* device)
     parameters->set(param::common::kPFunRegisterEvaluateCallbacks, common::registerEvaluateCallbacks);
 
     //! Plugin manager gives us the device type and the application id
-    json& config = *(json*)api::getContext()->loaderConfig;
-    auto deviceType = RenderAPI::eD3D12;
-    int appId = 0;
-    config.at("appId").get_to(appId);
-    config.at("deviceType").get_to(deviceType);
-    EngineType engine{};
-    std::string engineVersion{};
-    std::string projectId{};
-    if (config.contains("ngx"))
-    {
-        config.at("ngx").at("engineType").get_to(engine);
-        config.at("ngx").at("engineVersion").get_to(engineVersion);
-        config.at("ngx").at("projectId").get_to(projectId);
-    }
+    auto& config = api::getContext()->loaderConfig;
+    auto deviceType = config.getDeviceType();
+    int appId = config.getAppId();
+    EngineType engine = config.getEngineType();
+    std::string engineVersion = config.getEngineVersion();
+    std::string projectId = config.getProjectId();
 
     //! Some optional tweaks, NGX logging included in SL logging 
     LogLevel logLevelNGX = log::getInterface()->getLogLevel();
@@ -1568,12 +1558,14 @@ SL_EXPORT void* slGetPluginFunction(const char* functionName)
 {
     //! Forward declarations
     bool slOnPluginLoad(sl::param::IParameters * params, const char* loaderJSON, const char** pluginJSON);
+    bool slOnPluginSetLoaderConfig(const void* config, size_t size);
 
     //! Redirect to OTA if any
     SL_EXPORT_OTA;
 
     //! Core API
     SL_EXPORT_FUNCTION(slOnPluginLoad);
+    SL_EXPORT_FUNCTION(slOnPluginSetLoaderConfig);
     SL_EXPORT_FUNCTION(slOnPluginShutdown);
     SL_EXPORT_FUNCTION(slOnPluginStartup);
     SL_EXPORT_FUNCTION(slSetTag);
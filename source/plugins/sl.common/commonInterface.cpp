@@ -36,6 +36,7 @@
 #include "include/sl.h"
 #include "source/core/sl.api/internal.h"
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.trace/trace.h"
 #include "source/core/sl.thread/thread.h"
 #include "source/core/sl.plugin/plugin.h"
 #include "source/core/sl.extra/extra.h"
@@ -48,6 +49,7 @@
 #include "source/platforms/sl.chi/vulkan.h"
 #include "source/plugins/sl.common/commonInterface.h"
 #include "source/plugins/sl.imgui/imgui.h"
+#include "source/plugins/sl.imgui/timeSeries.h"
 
 #include "_artifacts/gitVersion.h"
 #include "external/nvapi/nvapi.h"
@@ -174,7 +176,7 @@ bool getSystemCaps(common::SystemCaps*& info)
     ctx.nvGPUCount = 0;
 
 #ifndef SL_PRODUCTION
-    bool forceNonNVDA = (*(json*)api::getContext()->loaderConfig)["forceNonNVDA"];
+    bool forceNonNVDA = api::getContext()->loaderConfig.isForceNonNVDA();
 #endif
 
     IDXGIFactory4* factory;
@@ -459,6 +461,23 @@ bool onLoad(const void* managerConfigPtr, const void* extraConfigPtr, chi::IReso
     {
         ctx.emulateLowVRAMScenario = extraConfig["emulateLowVRAMScenario"];
     }
+    {
+        // Watermarks are fractions of the OS reported VRAM budget, idle time is in milliseconds
+        chi::ResourcePoolEvictionPolicy policy{};
+        if (extraConfig.contains("vramSoftWatermark"))
+        {
+            extraConfig.at("vramSoftWatermark").get_to(policy.softWatermark);
+        }
+        if (extraConfig.contains("vramHardWatermark"))
+        {
+            extraConfig.at("vramHardWatermark").get_to(policy.hardWatermark);
+        }
+        if (extraConfig.contains("vramSoftIdleMs"))
+        {
+            extraConfig.at("vramSoftIdleMs").get_to(policy.softIdleMs);
+        }
+        ctx.pool->setEvictionPolicy(policy);
+    }
     return true; 
 }
 }
@@ -469,6 +488,8 @@ bool onLoad(const void* managerConfigPtr, const void* extraConfigPtr, chi::IReso
 //! callbacks for the requested feature (sl plugin)
 sl::Result slEvaluateFeatureInternal(sl::Feature feature, const sl::FrameToken& frame, const sl::BaseStructure** inputs, uint32_t numInputs, sl::CommandBuffer* cmdBuffer)
 {
+    SL_TRACE_SCOPE_ARG("sl.common.evaluate", feature);
+
     auto evalCallbacks = ctx.evalCallbacks[feature];
     if (!evalCallbacks.beginEvaluate || !evalCallbacks.endEvaluate)
     {
@@ -605,6 +626,23 @@ void presentCommon(UINT Flags)
                         ui->labelColored(highlightColor, "GPU: ", "%s", extra::format("Arch {} Rev {} Impl {}", ctx.sysCaps.adapters[0].architecture, ctx.sysCaps.adapters[0].revision, ctx.sysCaps.adapters[0].implementation).c_str());
                         ui->labelColored(highlightColor, "Render API: ", "%s", s_platforms[(uint32_t)ctx.platform].c_str());
                         ui->labelColored(highlightColor, "Volatile VRAM: ", "%.2fMB", commonBytes / (1024.0 * 1024.0));
+                        {
+                            chi::ResourcePoolStats poolStats{};
+                            ctx.pool->getStats(poolStats);
+                            ui->labelColored(highlightColor, "Volatile Pool: ", "%.2fMB idle, %.2fMB reclaimed (%llu evicted)", poolStats.idleBytes / (1024.0 * 1024.0),
+                                poolStats.reclaimedBytes / (1024.0 * 1024.0), poolStats.evictedCount);
+                        }
+                        {
+                            chi::VRAMSegmentStats segments[chi::kMaxNumVRAMSegments];
+                            uint32_t numSegments = chi::kMaxNumVRAMSegments;
+                            ctx.compute->getVRAMSegmentStats(segments, numSegments);
+                            // Skipping the global segment, it is already reported as the total below
+                            for (uint32_t i = 1; i < std::min(numSegments, chi::kMaxNumVRAMSegments); i++)
+                            {
+                                auto& seg = segments[i];
+                                ui->labelColored(highlightColor, extra::format("{} VRAM: ", seg.name).c_str(), "%.2fMB peak %.2fMB allocations %llu", seg.totalAllocatedSize / (1024.0 * 1024.0), seg.peakAllocatedSize / (1024.0 * 1024.0), seg.allocCount);
+                            }
+                        }
                         if (ctx.adapter)
                         {
                             DXGI_QUERY_VIDEO_MEMORY_INFO videoMemoryInfo{};
@@ -618,38 +656,15 @@ void presentCommon(UINT Flags)
                                 ui->labelColored(videoMemoryInfo.Budget > videoMemoryInfo.CurrentUsage ? highlightColor : warnColor, "VRAM: ", "SL %.2fGB Total %.2fGB Budget %.2fGB", bytes / (1024.0 * 1024.0 * 1024.0), videoMemoryInfo.CurrentUsage / (1024.0 * 1024.0 * 1024.0), videoMemoryInfo.Budget / (1024.0 * 1024.0 * 1024.0));
                             }
 
-                            const size_t kMaxNumGraphValues = 120;
-                            static std::vector<double> xAxis;
-                            static std::vector<double> yAxis[2];
-                            static double graphMinY = 0;
-                            static double graphMaxY = 0;
-                            if (xAxis.empty())
-                            {
-                                for (size_t i = 0; i < kMaxNumGraphValues; i++)
-                                {
-                                    xAxis.push_back((double)i);
-                                }
-                            }
-
-                            if (yAxis[0].size() == kMaxNumGraphValues)
-                            {
-                                yAxis[0].erase(yAxis[0].begin());
-                            }
-                            yAxis[0].push_back(videoMemoryInfo.CurrentUsage / (1024.0 * 1024.0 * 1024.0));
-
-                            if (yAxis[1].size() == kMaxNumGraphValues)
-                            {
-                                if (yAxis[1].front() == graphMinY) graphMinY = 1e20;
-                                if (yAxis[1].front() == graphMaxY) graphMaxY = 0;
-                                yAxis[1].erase(yAxis[1].begin());
-                            }
-                            yAxis[1].push_back(videoMemoryInfo.Budget / (1024.0 * 1024.0 * 1024.0));
-
-                            graphMaxY = std::max(graphMaxY, yAxis[1].back());
+                            const uint32_t kMaxNumGraphValues = 120;
+                            static imgui::TimeSeries s_vramGraph(kMaxNumGraphValues, 2);
+                            s_vramGraph.append((double)s_vramGraph.getCount(), { videoMemoryInfo.CurrentUsage / (1024.0 * 1024.0 * 1024.0), videoMemoryInfo.Budget / (1024.0 * 1024.0 * 1024.0) });
 
                             {
-                                imgui::Graph g = { "##vram", "VRAM", "GB", 0.0, (double)kMaxNumGraphValues, graphMinY, ((graphMaxY + 5) / 5) * 5, xAxis.data(), (uint32_t)yAxis[0].size() };
-                                std::vector<imgui::GraphValues> values = { {"Current",yAxis[0].data(),(uint32_t)yAxis[0].size(), imgui::GraphFlags::eShaded}, {"Budget",yAxis[1].data(),(uint32_t)yAxis[1].size(), imgui::GraphFlags::eNone} };
+                                auto numValues = s_vramGraph.prepare();
+                                auto minX = s_vramGraph.getPreparedMinX();
+                                imgui::Graph g = { "##vram", "VRAM", "GB", minX, minX + kMaxNumGraphValues, 0.0, ((s_vramGraph.getMax(1) + 5) / 5) * 5, s_vramGraph.getPreparedX(), numValues };
+                                std::vector<imgui::GraphValues> values = { {"Current",s_vramGraph.getPreparedY(0),numValues, imgui::GraphFlags::eShaded}, {"Budget",s_vramGraph.getPreparedY(1),numValues, imgui::GraphFlags::eNone} };
                                 ui->plotGraph(g, values);
                             }
                         }
@@ -41,6 +41,7 @@
 #include "source/platforms/sl.chi/vulkan.h"
 #include "source/plugins/sl.common/commonInterface.h"
 #include "source/plugins/sl.dlss/versions.h"
+#include "source/plugins/sl.dlss/dlssParameters.h"
 #include "source/plugins/sl.imgui/imgui.h"
 
 #include "source/platforms/sl.chi/capture.h"
@@ -65,12 +66,24 @@ using funNGXCreate = NVSDK_NGX_Result(*)(ID3D12GraphicsCommandList *InCmdList, N
 using funNGXRelease = NVSDK_NGX_Result(*)(NVSDK_NGX_Handle *InHandle);
 using funNGXEval = NVSDK_NGX_Result(*)(ID3D12GraphicsCommandList *InCmdList, const NVSDK_NGX_Handle *InHandle, const NVSDK_NGX_Parameter *InParameters, PFN_NVSDK_NGX_ProgressCallback InCallback);
 
+//! Features parked per viewport so toggling quality modes or resolutions does not recreate them
+//!
+//! Kept small since each feature holds output resolution history buffers.
+constexpr size_t kMaxNumCachedFeatures = 2;
+//! Optimal settings are cheap to store, covers all modes for a couple of output resolutions
+constexpr size_t kMaxNumCachedOptimalSettings = 16;
+
 struct DLSSViewport
 {
     uint32_t id = {};
     DLSSOptions consts{};
     DLSSOptimalSettings settings;
     NVSDK_NGX_Handle* handle = {};
+    //! Key the active handle was created with
+    dlss::CreateKey createKey{};
+    //! Create flags derived from options only, checked every frame to detect changes cheaply
+    int32_t optionCreateFlags{};
+    dlss::LRUCache<dlss::CreateKey, NVSDK_NGX_Handle*, kMaxNumCachedFeatures> cachedFeatures;
     sl::chi::Resource mvec;
     float2 inputTexelSize;
 };
@@ -118,6 +131,20 @@ struct DLSSContext
     std::map<uint32_t, DLSSViewport> viewports = {};
     DLSSViewport* viewport = {};
 
+    NGXParameterShadow ngxParams{};
+    LRUCache<OptimalSettingsKey, OptimalSettings, kMaxNumCachedOptimalSettings> cachedOptimalSettings;
+
+    //! All NGX parameter writes go through the shadow, drops cached data if NGX parameters were recreated
+    NGXParameterShadow& params()
+    {
+        if (ngxParams.get() != ngxContext->params)
+        {
+            cachedOptimalSettings.clear();
+        }
+        ngxParams.attach(ngxContext->params);
+        return ngxParams;
+    }
+
     RenderAPI platform;
 
     NVSDK_NGX_Resource_VK* cachedVkResource(sl::Resource* res)
@@ -285,11 +312,12 @@ Result slSetData(const BaseStructure* inputs, CommandBuffer* cmdBuffer)
 
     ctx.constsPerViewport.set(0, *viewport, consts);
 
-    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_DLAA, (uint32_t)consts->dlaaPreset);
-    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Quality, (uint32_t)consts->qualityPreset);
-    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Balanced, (uint32_t)consts->balancedPreset);
-    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Performance, (uint32_t)consts->performancePreset);
-    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_UltraPerformance, (uint32_t)consts->ultraPerformancePreset);
+    auto& params = ctx.params();
+    params.set(dlss::NGXParam::ePresetDLAA, (uint32_t)consts->dlaaPreset);
+    params.set(dlss::NGXParam::ePresetQuality, (uint32_t)consts->qualityPreset);
+    params.set(dlss::NGXParam::ePresetBalanced, (uint32_t)consts->balancedPreset);
+    params.set(dlss::NGXParam::ePresetPerformance, (uint32_t)consts->performancePreset);
+    params.set(dlss::NGXParam::ePresetUltraPerformance, (uint32_t)consts->ultraPerformancePreset);
 
     // NOTE: Nothing to do here when mode is set to off.
     // 
@@ -299,6 +327,49 @@ Result slSetData(const BaseStructure* inputs, CommandBuffer* cmdBuffer)
     return Result::eOk;
 }
 
+//! Create flags which depend on options and common constants only, resource dependent ones are added on top
+int32_t getOptionCreateFlags(const DLSSOptions& consts, const Constants& commonConsts)
+{
+    int32_t flags = 0;
+    if (consts.colorBuffersHDR == Boolean::eTrue)
+    {
+        flags |= NVSDK_NGX_DLSS_Feature_Flags_IsHDR;
+    }
+    if (consts.sharpness > 0.0f)
+    {
+        flags |= NVSDK_NGX_DLSS_Feature_Flags_DoSharpening;
+    }
+    if (commonConsts.depthInverted == Boolean::eTrue)
+    {
+        flags |= NVSDK_NGX_DLSS_Feature_Flags_DepthInverted;
+    }
+    if (commonConsts.motionVectorsJittered == Boolean::eTrue)
+    {
+        flags |= NVSDK_NGX_DLSS_Feature_Flags_MVJittered;
+    }
+    if (consts.structVersion >= sl::kStructVersion2 && consts.useAutoExposure)
+    {
+        flags |= NVSDK_NGX_DLSS_Feature_Flags_AutoExposure;
+    }
+    return flags;
+}
+
+//! Releases active and parked features, OK to call with null handles
+void releaseFeatures(dlss::DLSSContext& ctx, DLSSViewport& viewport)
+{
+    if (viewport.handle)
+    {
+        // Errors logged by sl.common
+        ctx.ngxContext->releaseFeature(viewport.handle, "sl.dlss");
+        viewport.handle = {};
+    }
+    for (auto& cached : viewport.cachedFeatures.entries())
+    {
+        ctx.ngxContext->releaseFeature(cached.value, "sl.dlss");
+    }
+    viewport.cachedFeatures.clear();
+}
+
 Result dlssBeginEvent(chi::CommandList pCmdList, const common::EventData& data, const sl::BaseStructure** inputs, uint32_t numInputs)
 {
     auto parameters = api::getContext()->parameters;
@@ -342,125 +413,148 @@ Result dlssBeginEvent(chi::CommandList pCmdList, const common::EventData& data,
         return Result::eErrorInvalidIntegration;
     }
 
+    int32_t optionCreateFlags = getOptionCreateFlags(*consts, *ctx.commonConsts);
+
     // Must check here, before we overwrite viewport.consts
-    bool modeOrSizeChanged = consts->mode != viewport.consts.mode || consts->outputWidth != viewport.consts.outputWidth || consts->outputHeight != viewport.consts.outputHeight;
+    bool optionsChanged = consts->mode != viewport.consts.mode || consts->outputWidth != viewport.consts.outputWidth || consts->outputHeight != viewport.consts.outputHeight ||
+        optionCreateFlags != viewport.optionCreateFlags ||
+        consts->dlaaPreset != viewport.consts.dlaaPreset || consts->qualityPreset != viewport.consts.qualityPreset || consts->balancedPreset != viewport.consts.balancedPreset ||
+        consts->performancePreset != viewport.consts.performancePreset || consts->ultraPerformancePreset != viewport.consts.ultraPerformancePreset;
 
     ctx.viewport = &viewport;
     viewport.consts = *consts;  // mandatory
+    viewport.optionCreateFlags = optionCreateFlags;
 
-    if(!viewport.handle || modeOrSizeChanged)
+    if(!viewport.handle || optionsChanged)
     {
-        ctx.commonConsts->reset = Boolean::eTrue;
-        ctx.cachedStates.clear();
         slGetData(consts, &viewport.settings, pCmdList);
 
         if(ctx.ngxContext)
         {
-            if (viewport.handle)
+            int32_t dlssCreateFlags = NVSDK_NGX_DLSS_Feature_Flags_MVLowRes | optionCreateFlags;
+
+            // Optional
+            CommonResource exposure = {};
+            getTaggedResource(kBufferTypeExposure, exposure, ctx.viewport->id, true, inputs, numInputs);
+            if (!exposure)
             {
-                SL_LOG_INFO("Detected resize, recreating DLSSContext feature");
-                // Errors logged by sl.common
-                ctx.ngxContext->releaseFeature(viewport.handle, "sl.dlss");
-                viewport.handle = {};
-                ctx.compute->destroyResource(viewport.mvec);
+                dlssCreateFlags |= NVSDK_NGX_DLSS_Feature_Flags_AutoExposure;
             }
 
+            // Mandatory
+            CommonResource colorIn{};
+            CommonResource colorOut{};
+            CommonResource depth{};
+            CommonResource mvec{};
+
+            SL_CHECK(getTaggedResource(kBufferTypeScalingInputColor, colorIn, ctx.viewport->id, false, inputs, numInputs));
+            SL_CHECK(getTaggedResource(kBufferTypeScalingOutputColor, colorOut, ctx.viewport->id, false, inputs, numInputs));
+            SL_CHECK(getTaggedResource(kBufferTypeDepth, depth, ctx.viewport->id, false, inputs, numInputs));
+            SL_CHECK(getTaggedResource(kBufferTypeMotionVectors, mvec, ctx.viewport->id, false, inputs, numInputs));
+
+            auto colorInExt = colorIn.getExtent();
+            auto colorOutExt = colorOut.getExtent();
+            auto depthExt = depth.getExtent();
+            auto mvecExt = mvec.getExtent();
+
+            // We will log the extent information for easier debugging, if not specified assuming the full buffer size
+            chi::ResourceDescription desc;
+            if (!colorInExt)
             {
-                int dlssCreateFlags = NVSDK_NGX_DLSS_Feature_Flags_MVLowRes;
-                if (consts->colorBuffersHDR == Boolean::eTrue)
-                {
-                    dlssCreateFlags |= NVSDK_NGX_DLSS_Feature_Flags_IsHDR;
-                }
-                if (consts->sharpness > 0.0f)
-                {
-                    dlssCreateFlags |= NVSDK_NGX_DLSS_Feature_Flags_DoSharpening;
-                }
-                if (ctx.commonConsts->depthInverted == Boolean::eTrue)
-                {
-                    dlssCreateFlags |= NVSDK_NGX_DLSS_Feature_Flags_DepthInverted;
-                }
-                if (ctx.commonConsts->motionVectorsJittered == Boolean::eTrue)
-                {
-                    dlssCreateFlags |= NVSDK_NGX_DLSS_Feature_Flags_MVJittered;
-                }
+                ctx.compute->getResourceState(colorIn.getState(), desc.state);
+                ctx.compute->getResourceDescription(colorIn, desc);
+                colorInExt = { 0,0,desc.width,desc.height };
+            }
+            if (!colorOutExt)
+            {
+                ctx.compute->getResourceState(colorOut.getState(), desc.state);
+                ctx.compute->getResourceDescription(colorOut, desc);
+                colorOutExt = { 0,0,desc.width,desc.height };
+            }
+            if (!mvecExt)
+            {
+                ctx.compute->getResourceState(mvec.getState(), desc.state);
+                ctx.compute->getResourceDescription(mvec, desc);
+                mvecExt = { 0,0,desc.width,desc.height };
+            }
+            if (!depthExt)
+            {
+                ctx.compute->getResourceState(depth.getState(), desc.state);
+                ctx.compute->getResourceDescription(depth, desc);
+                depthExt = { 0,0,desc.width,desc.height };
+            }
 
-                // Optional
-                CommonResource exposure = {};
-                getTaggedResource(kBufferTypeExposure, exposure, ctx.viewport->id, true, inputs, numInputs);
+            if (mvecExt.width > colorInExt.width || mvecExt.height > colorInExt.height)
+            {
+                SL_LOG_INFO("Detected high resolution mvec for DLSSContext");
+                dlssCreateFlags &= ~NVSDK_NGX_DLSS_Feature_Flags_MVLowRes;
+            }
 
-                if ((ctx.viewport->consts.structVersion >= sl::kStructVersion2 && ctx.viewport->consts.useAutoExposure) || !exposure)
-                {
-                    dlssCreateFlags |= NVSDK_NGX_DLSS_Feature_Flags_AutoExposure;
-                }
+            NVSDK_NGX_PerfQuality_Value perfQualityValue = (NVSDK_NGX_PerfQuality_Value)((uint32_t)viewport.consts.mode - 1);
+
+            dlss::CreateKey key{};
+            key.renderWidth = viewport.settings.optimalRenderWidth;
+            key.renderHeight = viewport.settings.optimalRenderHeight;
+            key.outputWidth = viewport.consts.outputWidth;
+            key.outputHeight = viewport.consts.outputHeight;
+            key.perfQuality = (uint32_t)perfQualityValue;
+            key.createFlags = dlssCreateFlags;
+            key.presets[0] = (uint32_t)viewport.consts.dlaaPreset;
+            key.presets[1] = (uint32_t)viewport.consts.qualityPreset;
+            key.presets[2] = (uint32_t)viewport.consts.balancedPreset;
+            key.presets[3] = (uint32_t)viewport.consts.performancePreset;
+            key.presets[4] = (uint32_t)viewport.consts.ultraPerformancePreset;
+
+            if (!viewport.handle || key != viewport.createKey)
+            {
+                ctx.commonConsts->reset = Boolean::eTrue;
+                ctx.cachedStates.clear();
 
-                // Mandatory
-                CommonResource colorIn{};
-                CommonResource colorOut{};
-                CommonResource depth{};
-                CommonResource mvec{};
-
-                SL_CHECK(getTaggedResource(kBufferTypeScalingInputColor, colorIn, ctx.viewport->id, false, inputs, numInputs));
-                SL_CHECK(getTaggedResource(kBufferTypeScalingOutputColor, colorOut, ctx.viewport->id, false, inputs, numInputs));
-                SL_CHECK(getTaggedResource(kBufferTypeDepth, depth, ctx.viewport->id, false, inputs, numInputs));
-                SL_CHECK(getTaggedResource(kBufferTypeMotionVectors, mvec, ctx.viewport->id, false, inputs, numInputs));
-
-                auto colorInExt = colorIn.getExtent();
-                auto colorOutExt = colorOut.getExtent();
-                auto depthExt = depth.getExtent();
-                auto mvecExt = mvec.getExtent();
-
-                // We will log the extent information for easier debugging, if not specified assuming the full buffer size
-                chi::ResourceDescription desc;
-                if (!colorInExt)
-                {
-                    ctx.compute->getResourceState(colorIn.getState(), desc.state);
-                    ctx.compute->getResourceDescription(colorIn, desc);
-                    colorInExt = { 0,0,desc.width,desc.height };
-                }
-                if (!colorOutExt)
+                if (viewport.handle)
                 {
-                    ctx.compute->getResourceState(colorOut.getState(), desc.state);
-                    ctx.compute->getResourceDescription(colorOut, desc);
-                    colorOutExt = { 0,0,desc.width,desc.height };
-                }
-                if (!mvecExt)
-                {
-                    ctx.compute->getResourceState(mvec.getState(), desc.state);
-                    ctx.compute->getResourceDescription(mvec, desc);
-                    mvecExt = { 0,0,desc.width,desc.height };
-                }
-                if (!depthExt)
-                {
-                    ctx.compute->getResourceState(depth.getState(), desc.state);
-                    ctx.compute->getResourceDescription(depth, desc);
-                    depthExt = { 0,0,desc.width,desc.height };
+                    SL_LOG_INFO("Detected mode or resize change, switching DLSSContext feature");
+                    // Park the current feature, least recently used one is released if cache is full
+                    NVSDK_NGX_Handle* evicted{};
+                    if (viewport.cachedFeatures.insert(viewport.createKey, viewport.handle, evicted))
+                    {
+                        // Errors logged by sl.common
+                        ctx.ngxContext->releaseFeature(evicted, "sl.dlss");
+                    }
+                    viewport.handle = {};
+                    ctx.compute->destroyResource(viewport.mvec);
                 }
 
-                if (mvecExt.width > colorInExt.width || mvecExt.height > colorInExt.height)
+                viewport.createKey = key;
+                if (viewport.cachedFeatures.take(key, viewport.handle))
                 {
-                    SL_LOG_INFO("Detected high resolution mvec for DLSSContext");
-                    dlssCreateFlags &= ~NVSDK_NGX_DLSS_Feature_Flags_MVLowRes;
+                    SL_LOG_INFO("Reusing DLSSContext feature (%u,%u)(optimal) -> (%u,%u) for viewport %u", key.renderWidth, key.renderHeight, key.outputWidth, key.outputHeight, data.id);
                 }
-
-                NVSDK_NGX_PerfQuality_Value perfQualityValue = (NVSDK_NGX_PerfQuality_Value)((uint32_t)viewport.consts.mode - 1);
-
-                ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_CreationNodeMask, 1);
-                ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_VisibilityNodeMask, 1);
-                ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Width, viewport.settings.optimalRenderWidth);
-                ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Height, viewport.settings.optimalRenderHeight);
-                ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_OutWidth, viewport.consts.outputWidth);
-                ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_OutHeight, viewport.consts.outputHeight);
-                ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_PerfQualityValue, perfQualityValue);
-                ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Feature_Create_Flags, dlssCreateFlags);
-                ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_FreeMemOnReleaseFeature, 1);
-                if (ctx.ngxContext->createFeature(pCmdList, NVSDK_NGX_Feature_SuperSampling, &viewport.handle, "sl.dlss"))
+                else
                 {
-                    SL_LOG_INFO("Created DLSSContext feature (%u,%u)(optimal) -> (%u,%u) for viewport %u", viewport.settings.optimalRenderWidth, viewport.settings.optimalRenderHeight, viewport.consts.outputWidth, viewport.consts.outputHeight, data.id);
-                    // Log the extent information for easier debugging
-                    SL_LOG_INFO("DLSSContext color_in extents (%u,%u,%u,%u)", colorInExt.left, colorInExt.top, colorInExt.width, colorInExt.height);
-                    SL_LOG_INFO("DLSSContext color_out extents (%u,%u,%u,%u)", colorOutExt.left, colorOutExt.top, colorOutExt.width, colorOutExt.height);
-                    SL_LOG_INFO("DLSSContext depth extents (%u,%u,%u,%u)", depthExt.left, depthExt.top, depthExt.width, depthExt.height);
-                    SL_LOG_INFO("DLSSContext mvec extents (%u,%u,%u,%u)", mvecExt.left, mvecExt.top, mvecExt.width, mvecExt.height);
+                    auto& params = ctx.params();
+                    params.set(dlss::NGXParam::ePresetDLAA, key.presets[0]);
+                    params.set(dlss::NGXParam::ePresetQuality, key.presets[1]);
+                    params.set(dlss::NGXParam::ePresetBalanced, key.presets[2]);
+                    params.set(dlss::NGXParam::ePresetPerformance, key.presets[3]);
+                    params.set(dlss::NGXParam::ePresetUltraPerformance, key.presets[4]);
+                    params.set(dlss::NGXParam::eCreationNodeMask, 1);
+                    params.set(dlss::NGXParam::eVisibilityNodeMask, 1);
+                    params.set(dlss::NGXParam::eWidth, viewport.settings.optimalRenderWidth);
+                    params.set(dlss::NGXParam::eHeight, viewport.settings.optimalRenderHeight);
+                    params.set(dlss::NGXParam::eOutWidth, viewport.consts.outputWidth);
+                    params.set(dlss::NGXParam::eOutHeight, viewport.consts.outputHeight);
+                    params.set(dlss::NGXParam::ePerfQualityValue, perfQualityValue);
+                    params.set(dlss::NGXParam::eCreateFlags, dlssCreateFlags);
+                    params.set(dlss::NGXParam::eFreeMemOnReleaseFeature, 1);
+                    if (ctx.ngxContext->createFeature(pCmdList, NVSDK_NGX_Feature_SuperSampling, &viewport.handle, "sl.dlss"))
+                    {
+                        SL_LOG_INFO("Created DLSSContext feature (%u,%u)(optimal) -> (%u,%u) for viewport %u", viewport.settings.optimalRenderWidth, viewport.settings.optimalRenderHeight, viewport.consts.outputWidth, viewport.consts.outputHeight, data.id);
+                        // Log the extent information for easier debugging
+                        SL_LOG_INFO("DLSSContext color_in extents (%u,%u,%u,%u)", colorInExt.left, colorInExt.top, colorInExt.width, colorInExt.height);
+                        SL_LOG_INFO("DLSSContext color_out extents (%u,%u,%u,%u)", colorOutExt.left, colorOutExt.top, colorOutExt.width, colorOutExt.height);
+                        SL_LOG_INFO("DLSSContext depth extents (%u,%u,%u,%u)", depthExt.left, depthExt.top, depthExt.width, depthExt.height);
+                        SL_LOG_INFO("DLSSContext mvec extents (%u,%u,%u,%u)", mvecExt.left, mvecExt.top, mvecExt.width, mvecExt.height);
+                    }
                 }
             }
         }
@@ -666,61 +760,61 @@ Result dlssEndEvent(chi::CommandList pCmdList, const common::EventData& data, co
                     };
                     ctx.compute->transitionResources(pCmdList, transitions, (uint32_t)countof(transitions), &revTransitions);
 
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Reset, consts->reset == Boolean::eTrue);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_MV_Scale_X, (mvecPixelSpace ? 1.0f : (float)(consts->mvecScale.x * renderWidth)));
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_MV_Scale_Y, (mvecPixelSpace ? 1.0f : (float)(consts->mvecScale.y * renderHeight)));
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Jitter_Offset_X, consts->jitterOffset.x);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Jitter_Offset_Y, consts->jitterOffset.y);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Sharpness, ctx.viewport->consts.sharpness);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Pre_Exposure, ctx.viewport->consts.preExposure);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Exposure_Scale, ctx.viewport->consts.exposureScale);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Sharpness, ctx.viewport->consts.sharpness);
+                    auto& params = ctx.params();
+                    params.set(dlss::NGXParam::eReset, consts->reset == Boolean::eTrue);
+                    params.set(dlss::NGXParam::eMVScaleX, (mvecPixelSpace ? 1.0f : (float)(consts->mvecScale.x * renderWidth)));
+                    params.set(dlss::NGXParam::eMVScaleY, (mvecPixelSpace ? 1.0f : (float)(consts->mvecScale.y * renderHeight)));
+                    params.set(dlss::NGXParam::eJitterOffsetX, consts->jitterOffset.x);
+                    params.set(dlss::NGXParam::eJitterOffsetY, consts->jitterOffset.y);
+                    params.set(dlss::NGXParam::eSharpness, ctx.viewport->consts.sharpness);
+                    params.set(dlss::NGXParam::ePreExposure, ctx.viewport->consts.preExposure);
+                    params.set(dlss::NGXParam::eExposureScale, ctx.viewport->consts.exposureScale);
 
                     if (ctx.platform == RenderAPI::eVulkan)
                     {
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Color, ctx.cachedVkResource(colorIn));
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_MotionVectors, ctx.cachedVkResource(mvecIn));
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Output, ctx.cachedVkResource(colorOut));
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_TransparencyMask, ctx.cachedVkResource(transparency));
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_ExposureTexture, ctx.cachedVkResource(exposure));
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Depth, ctx.cachedVkResource(depth));
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_Bias_Current_Color_Mask, ctx.cachedVkResource(currentColorBias));
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_AnimatedTextureMask, ctx.cachedVkResource(animTexture));
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_RayTracingHitDistance, ctx.cachedVkResource(rayTraceDist));
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_MotionVectorsReflection, ctx.cachedVkResource(mvecReflections));
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_IsParticleMask, ctx.cachedVkResource(particleMask));
+                        params.set(dlss::NGXParam::eColor, ctx.cachedVkResource(colorIn));
+                        params.set(dlss::NGXParam::eMotionVectors, ctx.cachedVkResource(mvecIn));
+                        params.set(dlss::NGXParam::eOutput, ctx.cachedVkResource(colorOut));
+                        params.set(dlss::NGXParam::eTransparencyMask, ctx.cachedVkResource(transparency));
+                        params.set(dlss::NGXParam::eExposureTexture, ctx.cachedVkResource(exposure));
+                        params.set(dlss::NGXParam::eDepth, ctx.cachedVkResource(depth));
+                        params.set(dlss::NGXParam::eBiasCurrentColorMask, ctx.cachedVkResource(currentColorBias));
+                        params.set(dlss::NGXParam::eAnimatedTextureMask, ctx.cachedVkResource(animTexture));
+                        params.set(dlss::NGXParam::eRayTracingHitDistance, ctx.cachedVkResource(rayTraceDist));
+                        params.set(dlss::NGXParam::eMotionVectorsReflection, ctx.cachedVkResource(mvecReflections));
+                        params.set(dlss::NGXParam::eIsParticleMask, ctx.cachedVkResource(particleMask));
                     }
                     else
                     {
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Color, (void*)colorIn);
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_MotionVectors, (void*)mvecIn);
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Output, (void*)colorOut);
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_TransparencyMask, (void*)transparency);
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_ExposureTexture, (void*)exposure);
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Depth, (void*)depth);
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_Bias_Current_Color_Mask, (void*)currentColorBias);
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_AnimatedTextureMask, (void*)animTexture);
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_RayTracingHitDistance, (void*)rayTraceDist);
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_MotionVectorsReflection, (void*)mvecReflections);
-                        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_IsParticleMask, (void*)particleMask);
+                        params.set(dlss::NGXParam::eColor, (void*)colorIn);
+                        params.set(dlss::NGXParam::eMotionVectors, (void*)mvecIn);
+                        params.set(dlss::NGXParam::eOutput, (void*)colorOut);
+                        params.set(dlss::NGXParam::eTransparencyMask, (void*)transparency);
+                        params.set(dlss::NGXParam::eExposureTexture, (void*)exposure);
+                        params.set(dlss::NGXParam::eDepth, (void*)depth);
+                        params.set(dlss::NGXParam::eBiasCurrentColorMask, (void*)currentColorBias);
+                        params.set(dlss::NGXParam::eAnimatedTextureMask, (void*)animTexture);
+                        params.set(dlss::NGXParam::eRayTracingHitDistance, (void*)rayTraceDist);
+                        params.set(dlss::NGXParam::eMotionVectorsReflection, (void*)mvecReflections);
+                        params.set(dlss::NGXParam::eIsParticleMask, (void*)particleMask);
                     }
 
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_Color_Subrect_Base_X, colorInExt.left);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_Color_Subrect_Base_Y, colorInExt.top);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_Depth_Subrect_Base_X, depthExt.left);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_Depth_Subrect_Base_Y, depthExt.top);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_MV_SubrectBase_X, mvecExt.left);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_MV_SubrectBase_Y, mvecExt.top);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_Translucency_SubrectBase_X, transparencyExt.left);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_Translucency_SubrectBase_Y, transparencyExt.top);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_Bias_Current_Color_SubrectBase_X, currentColorBiasExt.left);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Input_Bias_Current_Color_SubrectBase_Y, currentColorBiasExt.top);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Output_Subrect_Base_X, colorOutExt.left);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Output_Subrect_Base_Y, colorOutExt.top);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Render_Subrect_Dimensions_Width, renderWidth);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Render_Subrect_Dimensions_Height, renderHeight);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Indicator_Invert_X_Axis, ctx.viewport->consts.indicatorInvertAxisX);
-                    ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_DLSS_Indicator_Invert_Y_Axis, ctx.viewport->consts.indicatorInvertAxisY);
+                    params.set(dlss::NGXParam::eColorSubrectBaseX, colorInExt.left);
+                    params.set(dlss::NGXParam::eColorSubrectBaseY, colorInExt.top);
+                    params.set(dlss::NGXParam::eDepthSubrectBaseX, depthExt.left);
+                    params.set(dlss::NGXParam::eDepthSubrectBaseY, depthExt.top);
+                    params.set(dlss::NGXParam::eMVSubrectBaseX, mvecExt.left);
+                    params.set(dlss::NGXParam::eMVSubrectBaseY, mvecExt.top);
+                    params.set(dlss::NGXParam::eTranslucencySubrectBaseX, transparencyExt.left);
+                    params.set(dlss::NGXParam::eTranslucencySubrectBaseY, transparencyExt.top);
+                    params.set(dlss::NGXParam::eBiasCurrentColorSubrectBaseX, currentColorBiasExt.left);
+                    params.set(dlss::NGXParam::eBiasCurrentColorSubrectBaseY, currentColorBiasExt.top);
+                    params.set(dlss::NGXParam::eOutputSubrectBaseX, colorOutExt.left);
+                    params.set(dlss::NGXParam::eOutputSubrectBaseY, colorOutExt.top);
+                    params.set(dlss::NGXParam::eRenderSubrectWidth, renderWidth);
+                    params.set(dlss::NGXParam::eRenderSubrectHeight, renderHeight);
+                    params.set(dlss::NGXParam::eIndicatorInvertAxisX, ctx.viewport->consts.indicatorInvertAxisX);
+                    params.set(dlss::NGXParam::eIndicatorInvertAxisY, ctx.viewport->consts.indicatorInvertAxisY);
 
                     ctx.ngxContext->evaluateFeature(pCmdList, ctx.viewport->handle, "sl.dlss");
                 }
@@ -782,39 +876,60 @@ Result slGetData(const BaseStructure *inputs, BaseStructure *output, CommandBuff
         return Result::eErrorMissingInputParameter;
     }
 
+    auto& params = ctx.params();
+
     // Settings
     if (consts && settings)
     {
-        void* callback = NULL;
-        ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_DLSSOptimalSettingsCallback, &callback);
-        if (!callback)
+        // Toggling modes or resolutions hits the cache, NGX is only asked once per combination
+        dlss::OptimalSettingsKey key{ consts->outputWidth, consts->outputHeight, (uint32_t)consts->mode };
+        auto cached = ctx.cachedOptimalSettings.find(key);
+        if (!cached)
         {
-            SL_LOG_ERROR( "DLSSContext 'getOptimalSettings' callback is missing, please make sure DLSSContext feature is up to date");
-            return Result::eErrorNGXFailed;
-        }
-
-        // These are selections made by user in UI
-        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Width, consts->outputWidth);
-        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_Height, consts->outputHeight);
-        // SL DLSSContext modes start with 'off' so subtract one, the rest is mapped 1:1
-        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_PerfQualityValue, (NVSDK_NGX_PerfQuality_Value)((uint32_t)consts->mode - 1));
-        ctx.ngxContext->params->Set(NVSDK_NGX_Parameter_RTXValue, false);
+            void* callback = NULL;
+            ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_DLSSOptimalSettingsCallback, &callback);
+            if (!callback)
+            {
+                SL_LOG_ERROR( "DLSSContext 'getOptimalSettings' callback is missing, please make sure DLSSContext feature is up to date");
+                return Result::eErrorNGXFailed;
+            }
 
-        NVSDK_NGX_Result res = NVSDK_NGX_Result_Success;
-        auto getOptimalSettings = (PFN_NVSDK_NGX_DLSS_GetOptimalSettingsCallback)callback;
-        res = getOptimalSettings(ctx.ngxContext->params);
-        if (NVSDK_NGX_FAILED(res))
-        {
-            SL_LOG_ERROR( "DLSSContext 'getOptimalSettings' callback failed - error %u", res);
-            return Result::eErrorNGXFailed;
+            // These are selections made by user in UI
+            params.set(dlss::NGXParam::eWidth, consts->outputWidth);
+            params.set(dlss::NGXParam::eHeight, consts->outputHeight);
+            // SL DLSSContext modes start with 'off' so subtract one, the rest is mapped 1:1
+            params.set(dlss::NGXParam::ePerfQualityValue, (NVSDK_NGX_PerfQuality_Value)((uint32_t)consts->mode - 1));
+            params.set(dlss::NGXParam::eRTXValue, false);
+
+            NVSDK_NGX_Result res = NVSDK_NGX_Result_Success;
+            auto getOptimalSettings = (PFN_NVSDK_NGX_DLSS_GetOptimalSettingsCallback)callback;
+            res = getOptimalSettings(ctx.ngxContext->params);
+            // Callback writes its results into the parameter block
+            params.invalidate();
+            if (NVSDK_NGX_FAILED(res))
+            {
+                SL_LOG_ERROR( "DLSSContext 'getOptimalSettings' callback failed - error %u", res);
+                return Result::eErrorNGXFailed;
+            }
+            dlss::OptimalSettings optimal{};
+            ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_OutWidth, &optimal.renderWidth);
+            ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_OutHeight, &optimal.renderHeight);
+            ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_Sharpness, &optimal.sharpness);
+            ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Max_Render_Width, &optimal.renderWidthMax);
+            ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Max_Render_Height, &optimal.renderHeightMax);
+            ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Min_Render_Width, &optimal.renderWidthMin);
+            ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Min_Render_Height, &optimal.renderHeightMin);
+            dlss::OptimalSettings evicted{};
+            ctx.cachedOptimalSettings.insert(key, optimal, evicted);
+            cached = ctx.cachedOptimalSettings.find(key);
         }
-        ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_OutWidth, &settings->optimalRenderWidth);
-        ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_OutHeight, &settings->optimalRenderHeight);
-        ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_Sharpness, &settings->optimalSharpness);
-        ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Max_Render_Width, &settings->renderWidthMax);
-        ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Max_Render_Height, &settings->renderHeightMax);
-        ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Min_Render_Width, &settings->renderWidthMin);
-        ctx.ngxContext->params->Get(NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Min_Render_Height, &settings->renderHeightMin);
+        settings->optimalRenderWidth = cached->renderWidth;
+        settings->optimalRenderHeight = cached->renderHeight;
+        settings->optimalSharpness = cached->sharpness;
+        settings->renderWidthMax = cached->renderWidthMax;
+        settings->renderHeightMax = cached->renderHeightMax;
+        settings->renderWidthMin = cached->renderWidthMin;
+        settings->renderHeightMin = cached->renderHeightMin;
     }
     
     // Stats
@@ -829,6 +944,7 @@ Result slGetData(const BaseStructure *inputs, BaseStructure *output, CommandBuff
         }
         auto getStats = (PFN_NVSDK_NGX_DLSS_GetStatsCallback)callback;
         auto res = getStats(ctx.ngxContext->params);
+        params.invalidate();
         if (NVSDK_NGX_FAILED(res))
         {
             SL_LOG_ERROR( "DLSSContext 'getStats' callback failed - error %u", res);
@@ -856,10 +972,10 @@ Result slFreeResources(Feature feature, const sl::ViewportHandle& viewport)
     if (it != ctx.viewports.end())
     {
         auto& instance = (*it).second;
-        if (instance.handle)
+        if (instance.handle || !instance.cachedFeatures.entries().empty())
         {
             SL_LOG_INFO("Releasing DLSSContext instance id %u", viewport);
-            ctx.ngxContext->releaseFeature(instance.handle, "sl.dlss");
+            releaseFeatures(ctx, instance);
             // OK to release null resources
             CHI_VALIDATE(ctx.compute->destroyResource(instance.mvec));
         }
@@ -927,9 +1043,7 @@ bool slOnPluginStartup(const char* jsonConfig, void* device)
 #endif
 
     {
-        json& config = *(json*)api::getContext()->loaderConfig;
-        int appId = 0;
-        config.at("appId").get_to(appId);
+        int appId = api::getContext()->loaderConfig.getAppId();
     }
     
     ctx.compute->getRenderAPI(ctx.platform);
@@ -1008,9 +1122,9 @@ void slOnPluginShutdown()
     // Common shutdown
     plugin::onShutdown(api::getContext());
 
-    for(auto v : ctx.viewports)
+    for(auto& v : ctx.viewports)
     {
-        ctx.ngxContext->releaseFeature(v.second.handle, "sl.dlss");
+        releaseFeatures(ctx, v.second);
         CHI_VALIDATE(ctx.compute->destroyResource(v.second.mvec));
     }
     CHI_VALIDATE(ctx.compute->destroyKernel(ctx.mvecKernel));
@@ -1050,12 +1164,14 @@ SL_EXPORT void *slGetPluginFunction(const char *functionName)
 {
     // Forward declarations
     bool slOnPluginLoad(sl::param::IParameters* params, const char* loaderJSON, const char** pluginJSON);
+    bool slOnPluginSetLoaderConfig(const void* config, size_t size);
 
     //! Redirect to OTA if any
     SL_EXPORT_OTA;
 
     // Core API
     SL_EXPORT_FUNCTION(slOnPluginLoad);
+    SL_EXPORT_FUNCTION(slOnPluginSetLoaderConfig);
     SL_EXPORT_FUNCTION(slOnPluginShutdown);
     SL_EXPORT_FUNCTION(slOnPluginStartup);
     SL_EXPORT_FUNCTION(slSetData);
@@ -0,0 +1,338 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstring>
+#include <type_traits>
+
+#include "external/ngx-sdk/include/nvsdk_ngx_defs.h"
+#include "external/ngx-sdk/include/nvsdk_ngx_params.h"
+
+namespace sl
+{
+
+namespace dlss
+{
+
+//! Every NGX parameter sl.dlss writes, used to index the shadow block
+enum class NGXParam : uint32_t
+{
+    eCreationNodeMask,
+    eVisibilityNodeMask,
+    eWidth,
+    eHeight,
+    eOutWidth,
+    eOutHeight,
+    ePerfQualityValue,
+    eRTXValue,
+    eCreateFlags,
+    eFreeMemOnReleaseFeature,
+    ePresetDLAA,
+    ePresetQuality,
+    ePresetBalanced,
+    ePresetPerformance,
+    ePresetUltraPerformance,
+    eReset,
+    eMVScaleX,
+    eMVScaleY,
+    eJitterOffsetX,
+    eJitterOffsetY,
+    eSharpness,
+    ePreExposure,
+    eExposureScale,
+    eColor,
+    eMotionVectors,
+    eOutput,
+    eTransparencyMask,
+    eExposureTexture,
+    eDepth,
+    eBiasCurrentColorMask,
+    eAnimatedTextureMask,
+    eRayTracingHitDistance,
+    eMotionVectorsReflection,
+    eIsParticleMask,
+    eColorSubrectBaseX,
+    eColorSubrectBaseY,
+    eDepthSubrectBaseX,
+    eDepthSubrectBaseY,
+    eMVSubrectBaseX,
+    eMVSubrectBaseY,
+    eTranslucencySubrectBaseX,
+    eTranslucencySubrectBaseY,
+    eBiasCurrentColorSubrectBaseX,
+    eBiasCurrentColorSubrectBaseY,
+    eOutputSubrectBaseX,
+    eOutputSubrectBaseY,
+    eRenderSubrectWidth,
+    eRenderSubrectHeight,
+    eIndicatorInvertAxisX,
+    eIndicatorInvertAxisY,
+    eCount
+};
+
+//! IMPORTANT: Must match the order in NGXParam
+constexpr const char* kNGXParamNames[] =
+{
+    NVSDK_NGX_Parameter_CreationNodeMask,
+    NVSDK_NGX_Parameter_VisibilityNodeMask,
+    NVSDK_NGX_Parameter_Width,
+    NVSDK_NGX_Parameter_Height,
+    NVSDK_NGX_Parameter_OutWidth,
+    NVSDK_NGX_Parameter_OutHeight,
+    NVSDK_NGX_Parameter_PerfQualityValue,
+    NVSDK_NGX_Parameter_RTXValue,
+    NVSDK_NGX_Parameter_DLSS_Feature_Create_Flags,
+    NVSDK_NGX_Parameter_FreeMemOnReleaseFeature,
+    NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_DLAA,
+    NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Quality,
+    NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Balanced,
+    NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Performance,
+    NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_UltraPerformance,
+    NVSDK_NGX_Parameter_Reset,
+    NVSDK_NGX_Parameter_MV_Scale_X,
+    NVSDK_NGX_Parameter_MV_Scale_Y,
+    NVSDK_NGX_Parameter_Jitter_Offset_X,
+    NVSDK_NGX_Parameter_Jitter_Offset_Y,
+    NVSDK_NGX_Parameter_Sharpness,
+    NVSDK_NGX_Parameter_DLSS_Pre_Exposure,
+    NVSDK_NGX_Parameter_DLSS_Exposure_Scale,
+    NVSDK_NGX_Parameter_Color,
+    NVSDK_NGX_Parameter_MotionVectors,
+    NVSDK_NGX_Parameter_Output,
+    NVSDK_NGX_Parameter_TransparencyMask,
+    NVSDK_NGX_Parameter_ExposureTexture,
+    NVSDK_NGX_Parameter_Depth,
+    NVSDK_NGX_Parameter_DLSS_Input_Bias_Current_Color_Mask,
+    NVSDK_NGX_Parameter_AnimatedTextureMask,
+    NVSDK_NGX_Parameter_RayTracingHitDistance,
+    NVSDK_NGX_Parameter_MotionVectorsReflection,
+    NVSDK_NGX_Parameter_IsParticleMask,
+    NVSDK_NGX_Parameter_DLSS_Input_Color_Subrect_Base_X,
+    NVSDK_NGX_Parameter_DLSS_Input_Color_Subrect_Base_Y,
+    NVSDK_NGX_Parameter_DLSS_Input_Depth_Subrect_Base_X,
+    NVSDK_NGX_Parameter_DLSS_Input_Depth_Subrect_Base_Y,
+    NVSDK_NGX_Parameter_DLSS_Input_MV_SubrectBase_X,
+    NVSDK_NGX_Parameter_DLSS_Input_MV_SubrectBase_Y,
+    NVSDK_NGX_Parameter_DLSS_Input_Translucency_SubrectBase_X,
+    NVSDK_NGX_Parameter_DLSS_Input_Translucency_SubrectBase_Y,
+    NVSDK_NGX_Parameter_DLSS_Input_Bias_Current_Color_SubrectBase_X,
+    NVSDK_NGX_Parameter_DLSS_Input_Bias_Current_Color_SubrectBase_Y,
+    NVSDK_NGX_Parameter_DLSS_Output_Subrect_Base_X,
+    NVSDK_NGX_Parameter_DLSS_Output_Subrect_Base_Y,
+    NVSDK_NGX_Parameter_DLSS_Render_Subrect_Dimensions_Width,
+    NVSDK_NGX_Parameter_DLSS_Render_Subrect_Dimensions_Height,
+    NVSDK_NGX_Parameter_DLSS_Indicator_Invert_X_Axis,
+    NVSDK_NGX_Parameter_DLSS_Indicator_Invert_Y_Axis,
+};
+static_assert(sizeof(kNGXParamNames) / sizeof(kNGXParamNames[0]) == (size_t)NGXParam::eCount, "kNGXParamNames is out of sync with NGXParam");
+
+//! Shadow copy of the values last submitted to NVSDK_NGX_Parameter
+//!
+//! Values are forwarded to NGX only when they differ from the shadow, value type is part of
+//! the comparison so the same 'Set' overload is picked as when calling NGX directly.
+//!
+//! IMPORTANT: NGX callbacks like 'getOptimalSettings' write their results into the same
+//! parameter block so 'invalidate' must be called after them.
+class NGXParameterShadow
+{
+public:
+    //! Starts from scratch if NGX parameters were recreated
+    inline void attach(NVSDK_NGX_Parameter* params)
+    {
+        if (m_params != params)
+        {
+            m_params = params;
+            invalidate();
+        }
+    }
+
+    inline void invalidate()
+    {
+        m_values = {};
+    }
+
+    template<typename T>
+    inline void set(NGXParam param, T value)
+    {
+        static_assert(sizeof(T) <= sizeof(uint64_t), "Unsupported NGX parameter type");
+        Value v{};
+        v.type = getTypeTag<T>();
+        memcpy(&v.bits, &value, sizeof(T));
+        auto& shadow = m_values[(uint32_t)param];
+        if (shadow.type == v.type && shadow.bits == v.bits)
+        {
+            return;
+        }
+        shadow = v;
+        m_params->Set(kNGXParamNames[(uint32_t)param], value);
+    }
+
+    inline NVSDK_NGX_Parameter* get() const { return m_params; }
+
+private:
+
+    struct Value
+    {
+        //! Zero means nothing was submitted yet
+        uint32_t type{};
+        uint64_t bits{};
+    };
+
+    template<typename T>
+    static constexpr uint32_t getTypeTag()
+    {
+        uint32_t kind = std::is_pointer_v<T> ? 1 : std::is_floating_point_v<T> ? 2 : std::is_signed_v<T> ? 3 : 4;
+        return kind | ((uint32_t)sizeof(T) << 8);
+    }
+
+    NVSDK_NGX_Parameter* m_params{};
+    std::array<Value, (size_t)NGXParam::eCount> m_values{};
+};
+
+//! Everything that requires a new DLSS feature when changed
+struct CreateKey
+{
+    uint32_t renderWidth{};
+    uint32_t renderHeight{};
+    uint32_t outputWidth{};
+    uint32_t outputHeight{};
+    uint32_t perfQuality{};
+    int32_t createFlags{};
+    uint32_t presets[5]{};
+
+    inline bool operator==(const CreateKey& rhs) const { return memcmp(this, &rhs, sizeof(CreateKey)) == 0; }
+    inline bool operator!=(const CreateKey& rhs) const { return !operator==(rhs); }
+};
+static_assert(std::has_unique_object_representations_v<CreateKey>, "CreateKey is compared and hashed bytewise");
+
+//! Inputs of the NGX 'getOptimalSettings' callback
+struct OptimalSettingsKey
+{
+    uint32_t outputWidth{};
+    uint32_t outputHeight{};
+    uint32_t mode{};
+
+    inline bool operator==(const OptimalSettingsKey& rhs) const { return memcmp(this, &rhs, sizeof(OptimalSettingsKey)) == 0; }
+};
+static_assert(std::has_unique_object_representations_v<OptimalSettingsKey>, "OptimalSettingsKey is compared and hashed bytewise");
+
+//! Outputs of the NGX 'getOptimalSettings' callback, DLSSOptimalSettings carries the struct chain so it is not cached directly
+struct OptimalSettings
+{
+    uint32_t renderWidth{};
+    uint32_t renderHeight{};
+    float sharpness{};
+    uint32_t renderWidthMax{};
+    uint32_t renderHeightMax{};
+    uint32_t renderWidthMin{};
+    uint32_t renderHeightMin{};
+};
+
+//! FNV-1a
+template<typename T>
+inline uint64_t hashKey(const T& key)
+{
+    auto bytes = (const uint8_t*)&key;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < sizeof(T); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+//! Tiny LRU with linear lookup, front is the most recently used entry
+//!
+//! Meant for a handful of entries where a vector scan beats any node based container.
+template<typename Key, typename Value, size_t kCapacity>
+class LRUCache
+{
+public:
+    struct Entry
+    {
+        uint64_t hash;
+        Key key;
+        Value value;
+    };
+
+    //! Returns cached value and marks it as most recently used, null if not found
+    Value* find(const Key& key)
+    {
+        auto hash = hashKey(key);
+        for (size_t i = 0; i < m_entries.size(); i++)
+        {
+            if (m_entries[i].hash == hash && m_entries[i].key == key)
+            {
+                if (i > 0)
+                {
+                    auto entry = m_entries[i];
+                    m_entries.erase(m_entries.begin() + i);
+                    m_entries.insert(m_entries.begin(), entry);
+                }
+                return &m_entries.front().value;
+            }
+        }
+        return nullptr;
+    }
+
+    //! Removes entry and returns its value, false if not found
+    bool take(const Key& key, Value& value)
+    {
+        auto hash = hashKey(key);
+        for (size_t i = 0; i < m_entries.size(); i++)
+        {
+            if (m_entries[i].hash == hash && m_entries[i].key == key)
+            {
+                value = m_entries[i].value;
+                m_entries.erase(m_entries.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Inserts as most recently used, returns true and the least recently used value if one had to be evicted
+    bool insert(const Key& key, const Value& value, Value& evicted)
+    {
+        bool full = m_entries.size() >= kCapacity;
+        if (full)
+        {
+            evicted = m_entries.back().value;
+            m_entries.pop_back();
+        }
+        m_entries.insert(m_entries.begin(), { hashKey(key), key, value });
+        return full;
+    }
+
+    inline const std::vector<Entry>& entries() const { return m_entries; }
+    inline void clear() { m_entries.clear(); }
+
+private:
+    std::vector<Entry> m_entries;
+};
+
+}
+}
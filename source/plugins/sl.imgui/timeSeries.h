@@ -0,0 +1,261 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <initializer_list>
+
+namespace sl
+{
+
+namespace imgui
+{
+
+constexpr uint32_t kMaxNumTimeSeriesChannels = 4;
+
+//! Fixed capacity time series for 'plotGraph', samples live in SoA ring buffers
+//!
+//! One producer thread appends without locks or allocations, one consumer (normally a render callback)
+//! calls 'prepare' to get the samples in chronological order as plain arrays, decimated with LTTB
+//! when there are more samples than points requested. All channels share the same x values.
+//!
+//! Min/max over the current window are maintained by the producer with monotonic wedges so they
+//! can be read at any time in constant time.
+class TimeSeries
+{
+public:
+    TimeSeries(uint32_t capacity, uint32_t numChannels) :
+        m_capacity(std::max(capacity, 3u)),
+        m_numSlots(m_capacity + 1),
+        m_numChannels(std::min(std::max(numChannels, 1u), kMaxNumTimeSeriesChannels))
+    {
+        m_x.resize(m_numSlots);
+        m_y.resize(m_numSlots * m_numChannels);
+        m_minWedge.resize(m_capacity * m_numChannels);
+        m_maxWedge.resize(m_capacity * m_numChannels);
+        m_copyX.resize(m_capacity);
+        m_copyY.resize(m_capacity * m_numChannels);
+        m_plotX.resize(m_capacity);
+        m_plotY.resize(m_capacity * m_numChannels);
+    }
+
+    TimeSeries(const TimeSeries&) = delete;
+    TimeSeries& operator=(const TimeSeries&) = delete;
+
+    //! Producer only, 'y' must provide a value for each channel
+    void append(double x, const double* y)
+    {
+        auto head = m_head.load(std::memory_order_relaxed);
+        auto slot = uint32_t(head % m_numSlots);
+        m_x[slot] = x;
+        for (uint32_t c = 0; c < m_numChannels; c++)
+        {
+            m_y[c * m_numSlots + slot] = y[c];
+            m_min[c].store(updateWedge(m_minWedge.data() + c * m_capacity, m_minRange[c], head, y[c], false), std::memory_order_relaxed);
+            m_max[c].store(updateWedge(m_maxWedge.data() + c * m_capacity, m_maxRange[c], head, y[c], true), std::memory_order_relaxed);
+        }
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    void append(double x, std::initializer_list<double> y)
+    {
+        double values[kMaxNumTimeSeriesChannels]{};
+        std::copy_n(y.begin(), std::min((uint32_t)y.size(), m_numChannels), values);
+        append(x, values);
+    }
+
+    //! Total number of samples appended so far, not limited by the capacity
+    uint64_t getCount() const { return m_head.load(std::memory_order_acquire); }
+    uint32_t getCapacity() const { return m_capacity; }
+    uint32_t getNumChannels() const { return m_numChannels; }
+    double getMin(uint32_t channel) const { return m_min[channel].load(std::memory_order_relaxed); }
+    double getMax(uint32_t channel) const { return m_max[channel].load(std::memory_order_relaxed); }
+
+    //! Consumer only, copies the current window in chronological order and returns the number of points
+    //!
+    //! If 'maxPoints' is non zero and smaller than the window, points are selected with LTTB
+    //! (largest triangle three buckets) using the sum of triangle areas across all channels.
+    uint32_t prepare(uint32_t maxPoints = 0)
+    {
+        auto head = m_head.load(std::memory_order_acquire);
+        auto tail = head > m_capacity ? head - m_capacity : 0;
+        for (auto i = tail; i < head; i++)
+        {
+            auto slot = uint32_t(i % m_numSlots);
+            auto dst = uint32_t(i - tail);
+            m_copyX[dst] = m_x[slot];
+            for (uint32_t c = 0; c < m_numChannels; c++)
+            {
+                m_copyY[c * m_capacity + dst] = m_y[c * m_numSlots + slot];
+            }
+        }
+        // Drop anything the producer might have overwritten while we were copying, the spare slot
+        // holds the sample being written so nothing is dropped unless the producer got ahead of us
+        auto headAfterCopy = m_head.load(std::memory_order_acquire);
+        auto validTail = headAfterCopy >= m_numSlots ? headAfterCopy - m_numSlots + 1 : 0;
+        auto skip = uint32_t(validTail > tail ? std::min(validTail, head) - tail : 0);
+        auto count = uint32_t(head - tail) - skip;
+
+        if (maxPoints < 3 || count <= maxPoints)
+        {
+            std::copy_n(m_copyX.begin() + skip, count, m_plotX.begin());
+            for (uint32_t c = 0; c < m_numChannels; c++)
+            {
+                std::copy_n(m_copyY.begin() + c * m_capacity + skip, count, m_plotY.begin() + c * m_capacity);
+            }
+            m_preparedCount = count;
+        }
+        else
+        {
+            m_preparedCount = decimate(skip, count, maxPoints);
+        }
+        return m_preparedCount;
+    }
+
+    //! Results of the last 'prepare' call, valid until 'prepare' is called again
+    double* getPreparedX() { return m_plotX.data(); }
+    double* getPreparedY(uint32_t channel) { return m_plotY.data() + channel * m_capacity; }
+    uint32_t getPreparedCount() const { return m_preparedCount; }
+    double getPreparedMinX() const { return m_preparedCount ? m_plotX[0] : 0.0; }
+    double getPreparedMaxX() const { return m_preparedCount ? m_plotX[m_preparedCount - 1] : 0.0; }
+
+private:
+
+    struct WedgeItem
+    {
+        uint64_t index;
+        double value;
+    };
+    struct WedgeRange
+    {
+        uint64_t front{};
+        uint64_t back{};
+    };
+
+    //! Sliding window extreme in amortized constant time, wedge holds at most 'capacity' items
+    inline double updateWedge(WedgeItem* wedge, WedgeRange& range, uint64_t index, double value, bool isMax)
+    {
+        // Expire the sample which just left the window
+        if (range.front < range.back && index >= m_capacity && wedge[range.front % m_capacity].index <= index - m_capacity)
+        {
+            range.front++;
+        }
+        while (range.front < range.back)
+        {
+            auto& last = wedge[(range.back - 1) % m_capacity];
+            if (isMax ? last.value > value : last.value < value) break;
+            range.back--;
+        }
+        wedge[range.back % m_capacity] = { index, value };
+        range.back++;
+        return wedge[range.front % m_capacity].value;
+    }
+
+    uint32_t decimate(uint32_t first, uint32_t count, uint32_t maxPoints)
+    {
+        auto x = m_copyX.data() + first;
+        auto y = [this, first](uint32_t c, uint32_t i)->double { return m_copyY[c * m_capacity + first + i]; };
+        auto emit = [this, x, &y](uint32_t dst, uint32_t src)->void
+        {
+            m_plotX[dst] = x[src];
+            for (uint32_t c = 0; c < m_numChannels; c++)
+            {
+                m_plotY[c * m_capacity + dst] = y(c, src);
+            }
+        };
+
+        // First and last points are always kept, everything in between is split into equally sized buckets
+        double bucketSize = double(count - 2) / double(maxPoints - 2);
+        uint32_t selected = 0;
+        emit(0, 0);
+        for (uint32_t bucket = 0; bucket < maxPoints - 2; bucket++)
+        {
+            auto begin = uint32_t(bucket * bucketSize) + 1;
+            auto end = std::min(uint32_t((bucket + 1) * bucketSize) + 1, count - 1);
+            auto nextBegin = end;
+            auto nextEnd = std::min(uint32_t((bucket + 2) * bucketSize) + 1, count);
+
+            // Third vertex of the triangle is the average of the next bucket
+            double avgX = 0;
+            double avgY[kMaxNumTimeSeriesChannels]{};
+            for (auto i = nextBegin; i < nextEnd; i++)
+            {
+                avgX += x[i];
+                for (uint32_t c = 0; c < m_numChannels; c++) avgY[c] += y(c, i);
+            }
+            auto n = double(std::max(nextEnd - nextBegin, 1u));
+            avgX /= n;
+            for (uint32_t c = 0; c < m_numChannels; c++) avgY[c] /= n;
+
+            double maxArea = -1.0;
+            uint32_t best = begin;
+            for (auto i = begin; i < end; i++)
+            {
+                double area = 0;
+                for (uint32_t c = 0; c < m_numChannels; c++)
+                {
+                    area += std::abs((x[selected] - avgX) * (y(c, i) - y(c, selected)) - (x[selected] - x[i]) * (avgY[c] - y(c, selected)));
+                }
+                if (area > maxArea)
+                {
+                    maxArea = area;
+                    best = i;
+                }
+            }
+            selected = best;
+            emit(bucket + 1, selected);
+        }
+        emit(maxPoints - 1, count - 1);
+        return maxPoints;
+    }
+
+    const uint32_t m_capacity;
+    //! One extra slot so the sample currently being appended never overlaps the window seen by the consumer
+    const uint32_t m_numSlots;
+    const uint32_t m_numChannels;
+    std::atomic<uint64_t> m_head{};
+
+    // Producer side
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<WedgeItem> m_minWedge;
+    std::vector<WedgeItem> m_maxWedge;
+    WedgeRange m_minRange[kMaxNumTimeSeriesChannels]{};
+    WedgeRange m_maxRange[kMaxNumTimeSeriesChannels]{};
+    std::atomic<double> m_min[kMaxNumTimeSeriesChannels]{};
+    std::atomic<double> m_max[kMaxNumTimeSeriesChannels]{};
+
+    // Consumer side
+    std::vector<double> m_copyX;
+    std::vector<double> m_copyY;
+    std::vector<double> m_plotX;
+    std::vector<double> m_plotY;
+    uint32_t m_preparedCount{};
+};
+
+}
+}
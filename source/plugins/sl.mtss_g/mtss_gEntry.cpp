@@ -1283,11 +1283,9 @@ bool slOnPluginStartup(const char* jsonConfig, void* device)
 
     auto parameters = api::getContext()->parameters;
 
-    json&    config = *(json*)api::getContext()->loaderConfig;
-    uint32_t deviceType{};
-    int      appId{};
-    config.at("appId").get_to(appId);
-    config.at("deviceType").get_to(deviceType);
+    auto&    config = api::getContext()->loaderConfig;
+    auto     deviceType = config.getDeviceType();
+    int      appId = config.getAppId();
 
     ctx.platform = (RenderAPI)deviceType;
     if (ctx.platform != RenderAPI::eD3D11)
@@ -1596,9 +1594,11 @@ SL_EXPORT void* slGetPluginFunction(const char* functionName)
 {
     //! Forward declarations
     bool slOnPluginLoad(sl::param::IParameters * params, const char* loaderJSON, const char** pluginJSON);
+    bool slOnPluginSetLoaderConfig(const void* config, size_t size);
 
     //! Core API
     SL_EXPORT_FUNCTION(slOnPluginLoad);
+    SL_EXPORT_FUNCTION(slOnPluginSetLoaderConfig);
     SL_EXPORT_FUNCTION(slOnPluginShutdown);
     SL_EXPORT_FUNCTION(slOnPluginStartup);
     SL_EXPORT_FUNCTION(slSetConstants);
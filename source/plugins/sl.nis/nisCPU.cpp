@@ -0,0 +1,712 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+// MSVC accepts AVX2 intrinsics without /arch:AVX2 so the path is always compiled in and selected at runtime
+#include <intrin.h>
+#include <immintrin.h>
+#define SL_NIS_CPU_AVX2 1
+#define SL_NIS_CPU_RUNTIME_CHECK 1
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define SL_NIS_CPU_AVX2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SL_NIS_CPU_NEON 1
+#endif
+
+#include "source/core/sl.log/log.h"
+#include "source/plugins/sl.nis/nisCPU.h"
+
+namespace sl
+{
+
+namespace nis
+{
+
+namespace cpu
+{
+
+namespace
+{
+
+//! Log interface is only provided when loaded by the plugin manager, headless callers rely on the return value
+#define SL_NIS_CPU_LOG_ERROR(fmt, ...) do { if (sl::log::getInterface()) SL_LOG_ERROR(fmt, ##__VA_ARGS__); } while (0)
+
+//! Same value as in NIS_Scaler.h
+constexpr float kHDRCompression = 0.282842712f;
+
+//! Luma plane apron, wide enough for 8 lane loads starting two pixels left of the leftmost tap
+constexpr int kPadX = 8;
+constexpr int kPadY = 4;
+
+struct Float4
+{
+    float x, y, z, w;
+};
+
+struct alignas(32) Coefficients
+{
+    float scale[kPhaseCount][kFilterSize];
+    float usm[kPhaseCount][kFilterSize];
+};
+
+inline float halfToFloat(uint16_t h)
+{
+    uint32_t sign = uint32_t(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0x1f)
+    {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else if (exponent)
+    {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    else if (mantissa)
+    {
+        // Denormal, normalize into fp32
+        exponent = 127 - 15 + 1;
+        while (!(mantissa & 0x400))
+        {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    else
+    {
+        bits = sign;
+    }
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+const Coefficients& getCoefficients(CoefficientPrecision precision)
+{
+    static const Coefficients s_fp32 = []()->Coefficients
+    {
+        Coefficients c{};
+        memcpy(c.scale, coef_scale, sizeof(c.scale));
+        memcpy(c.usm, coef_usm, sizeof(c.usm));
+        return c;
+    }();
+    static const Coefficients s_fp16 = []()->Coefficients
+    {
+        Coefficients c{};
+        for (size_t i = 0; i < kPhaseCount; i++)
+        {
+            for (size_t j = 0; j < kFilterSize; j++)
+            {
+                c.scale[i][j] = halfToFloat(coef_scale_fp16[i][j]);
+                c.usm[i][j] = halfToFloat(coef_usm_fp16[i][j]);
+            }
+        }
+        return c;
+    }();
+    return precision == CoefficientPrecision::eFP16 ? s_fp16 : s_fp32;
+}
+
+//! Eight wide multiply-add and dot product, tables are padded to kFilterSize
+//! with zeros so the two extra lanes never contribute.
+struct ScalarOps
+{
+    struct V { float v[8]; };
+    static inline V load(const float* p) { V r; for (int i = 0; i < 8; i++) r.v[i] = p[i]; return r; }
+    static inline V zero() { return V{}; }
+    static inline V madd(const V& a, float b, const V& c) { V r; for (int i = 0; i < 8; i++) r.v[i] = a.v[i] * b + c.v[i]; return r; }
+    static inline float dot(const V& a, const float* b) { float r = 0.0f; for (int i = 0; i < 6; i++) r += a.v[i] * b[i]; return r; }
+};
+
+#if SL_NIS_CPU_AVX2
+struct SIMDOps
+{
+    using V = __m256;
+    static inline V load(const float* p) { return _mm256_loadu_ps(p); }
+    static inline V zero() { return _mm256_setzero_ps(); }
+    static inline V madd(const V& a, float b, const V& c) { return _mm256_add_ps(_mm256_mul_ps(a, _mm256_set1_ps(b)), c); }
+    static inline float dot(const V& a, const float* b)
+    {
+        auto m = _mm256_mul_ps(a, _mm256_loadu_ps(b));
+        auto s = _mm_add_ps(_mm256_castps256_ps128(m), _mm256_extractf128_ps(m, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+};
+#elif SL_NIS_CPU_NEON
+struct SIMDOps
+{
+    using V = float32x4x2_t;
+    static inline V load(const float* p) { return { vld1q_f32(p), vld1q_f32(p + 4) }; }
+    static inline V zero() { return { vdupq_n_f32(0.0f), vdupq_n_f32(0.0f) }; }
+    static inline V madd(const V& a, float b, const V& c) { return { vmlaq_n_f32(c.val[0], a.val[0], b), vmlaq_n_f32(c.val[1], a.val[1], b) }; }
+    static inline float dot(const V& a, const float* b)
+    {
+        auto m = vmlaq_f32(vmulq_f32(a.val[0], vld1q_f32(b)), a.val[1], vld1q_f32(b + 4));
+        return vaddvq_f32(m);
+    }
+};
+#endif
+
+inline float saturate(float v) { return std::min(std::max(v, 0.0f), 1.0f); }
+inline float lerp(float a, float b, float t) { return a + (b - a) * t; }
+inline Float4 lerp(const Float4& a, const Float4& b, float t)
+{
+    return { lerp(a.x, b.x, t), lerp(a.y, b.y, t), lerp(a.z, b.z, t), lerp(a.w, b.w, t) };
+}
+
+template<NISHDRMode kHDRMode>
+inline float getY(const float* rgba)
+{
+    if constexpr (kHDRMode == NISHDRMode::PQ)
+    {
+        return 0.262f * rgba[0] + 0.678f * rgba[1] + 0.0593f * rgba[2];
+    }
+    else if constexpr (kHDRMode == NISHDRMode::Linear)
+    {
+        return sqrtf(0.2126f * rgba[0] + 0.7152f * rgba[1] + 0.0722f * rgba[2]) * kHDRCompression;
+    }
+    else
+    {
+        return 0.2126f * rgba[0] + 0.7152f * rgba[1] + 0.0722f * rgba[2];
+    }
+}
+
+inline float getYLinear(const float* rgba)
+{
+    return 0.2126f * rgba[0] + 0.7152f * rgba[1] + 0.0722f * rgba[2];
+}
+
+//! Luma of the input viewport plus an apron, texels outside of the texture are clamped like the shader sampler does
+struct LumaPlane
+{
+    std::vector<float> data;
+    int pitch{};
+
+    template<NISHDRMode kHDRMode>
+    void build(const Image& input, int originX, int originY, int width, int height)
+    {
+        pitch = width + 2 * kPadX;
+        data.resize(size_t(pitch) * (height + 2 * kPadY));
+        for (int y = -kPadY; y < height + kPadY; y++)
+        {
+            auto ty = std::clamp(originY + y, 0, int(input.height) - 1);
+            auto src = input.data + size_t(ty) * input.pitch * 4;
+            auto dst = row(y);
+            for (int x = -kPadX; x < width + kPadX; x++)
+            {
+                auto tx = std::clamp(originX + x, 0, int(input.width) - 1);
+                dst[x] = getY<kHDRMode>(src + tx * 4);
+            }
+        }
+    }
+
+    //! Pointer to pixel 0 of the given viewport row, valid for [-kPadX, width + kPadX)
+    inline const float* row(int y) const { return data.data() + size_t(y + kPadY) * pitch + kPadX; }
+    inline float* row(int y) { return data.data() + size_t(y + kPadY) * pitch + kPadX; }
+};
+
+//! Bilinear fetch with clamp addressing, x and y are in texels with 0 at the center of the first texel
+inline void sampleBilinear(const Image& input, float x, float y, float* rgba)
+{
+    const float fx = floorf(x);
+    const float fy = floorf(y);
+    const float tx = x - fx;
+    const float ty = y - fy;
+    const int maxX = int(input.width) - 1;
+    const int maxY = int(input.height) - 1;
+    const int x0 = std::clamp(int(fx), 0, maxX);
+    const int x1 = std::clamp(int(fx) + 1, 0, maxX);
+    const int y0 = std::clamp(int(fy), 0, maxY);
+    const int y1 = std::clamp(int(fy) + 1, 0, maxY);
+    auto r0 = input.data + size_t(y0) * input.pitch * 4;
+    auto r1 = input.data + size_t(y1) * input.pitch * 4;
+    for (int c = 0; c < 4; c++)
+    {
+        rgba[c] = lerp(lerp(r0[x0 * 4 + c], r0[x1 * 4 + c], tx), lerp(r1[x0 * 4 + c], r1[x1 * 4 + c], tx), ty);
+    }
+}
+
+//! GetEdgeMap from NIS_Scaler.h, rows point to the top left pixel of the 3x3 neighbourhood
+inline Float4 getEdgeMap(const NISConfig& c, const float* r0, const float* r1, const float* r2)
+{
+    const float g_0 = fabsf(r0[0] + r0[1] + r0[2] - r2[0] - r2[1] - r2[2]);
+    const float g_45 = fabsf(r1[0] + r0[0] + r0[1] - r2[1] - r2[2] - r1[2]);
+    const float g_90 = fabsf(r0[0] + r1[0] + r2[0] - r0[2] - r1[2] - r2[2]);
+    const float g_135 = fabsf(r1[0] + r2[0] + r2[1] - r0[1] - r0[2] - r1[2]);
+
+    const float g_0_90_max = std::max(g_0, g_90);
+    const float g_0_90_min = std::min(g_0, g_90);
+    const float g_45_135_max = std::max(g_45, g_135);
+    const float g_45_135_min = std::min(g_45, g_135);
+
+    if (g_0_90_max + g_45_135_max == 0)
+    {
+        return {};
+    }
+
+    const float e_0_90 = std::min(g_0_90_max / (g_0_90_max + g_45_135_max), 1.0f);
+    const float e_45_135 = 1.0f - e_0_90;
+
+    const bool c_0_90 = (g_0_90_max > (g_0_90_min * c.kDetectRatio)) && (g_0_90_max > c.kDetectThres) && (g_0_90_max > g_45_135_min);
+    const bool c_45_135 = (g_45_135_max > (g_45_135_min * c.kDetectRatio)) && (g_45_135_max > c.kDetectThres) && (g_45_135_max > g_0_90_min);
+    const bool c_g_0_90 = g_0_90_max == g_0;
+    const bool c_g_45_135 = g_45_135_max == g_45;
+
+    const float f_e_0_90 = (c_0_90 && c_45_135) ? e_0_90 : 1.0f;
+    const float f_e_45_135 = (c_0_90 && c_45_135) ? e_45_135 : 1.0f;
+
+    return {
+        (c_0_90 && c_g_0_90) ? f_e_0_90 : 0.0f,
+        (c_0_90 && !c_g_0_90) ? f_e_0_90 : 0.0f,
+        (c_45_135 && c_g_45_135) ? f_e_45_135 : 0.0f,
+        (c_45_135 && !c_g_45_135) ? f_e_45_135 : 0.0f
+    };
+}
+
+inline float contrastWeight(const NISConfig& c, float aMin, float aMax, float bMin, float bMax)
+{
+    const float a_cont = aMax - aMin;
+    const float b_cont = bMax - bMin;
+    const float cont_ratio = std::max(a_cont, b_cont) / (std::min(a_cont, b_cont) + c.kEps);
+    return (1.0f - saturate((cont_ratio - c.kMinContrastRatio) * c.kRatioNorm)) * c.kContrastBoost;
+}
+
+//! NVScaler, one instance per HDR mode and instruction set
+template<NISHDRMode kHDRMode, typename Ops>
+struct Scaler
+{
+    Scaler(const NISConfig& config, const Coefficients& coefficients) : c(config), coef(coefficients) {}
+
+    const NISConfig& c;
+    const Coefficients& coef;
+    LumaPlane luma;
+    //! Edge map for viewport pixels [-1, width] x [-1, height]
+    std::vector<Float4> edges;
+    int edgePitch{};
+
+    inline float calcLTI(const float* p, int phase) const
+    {
+        const bool selector = phase <= int(kPhaseCount / 2);
+        float sel = selector ? p[0] : p[3];
+        const float a_min = std::min(std::min(p[1], p[2]), sel);
+        const float a_max = std::max(std::max(p[1], p[2]), sel);
+        sel = selector ? p[2] : p[5];
+        const float b_min = std::min(std::min(p[3], p[4]), sel);
+        const float b_max = std::max(std::max(p[3], p[4]), sel);
+        return contrastWeight(c, a_min, a_max, b_min, b_max);
+    }
+
+    //! 'pxl' holds 6 taps followed by two zeros
+    inline float evalPoly6(const float* pxl, int phase) const
+    {
+        const auto v = Ops::load(pxl);
+        const float y = Ops::dot(v, coef.scale[phase]);
+        float y_usm = Ops::dot(v, coef.usm[phase]);
+
+        // piece-wise ramp based on luma
+        const float y_scale = 1.0f - saturate((y - c.kSharpStartY) * c.kSharpScaleY);
+        // sharpen as a function of luma
+        y_usm *= y_scale * c.kSharpStrengthScale + c.kSharpStrengthMin;
+        // limit USM as a function of luma
+        const float y_sharpness_limit = (y_scale * c.kSharpLimitScale + c.kSharpLimitMin) * y;
+        y_usm = std::min(y_sharpness_limit, std::max(-y_sharpness_limit, y_usm));
+        // reduce ringing
+        y_usm *= calcLTI(pxl, phase);
+        return y + y_usm;
+    }
+
+    //! Separable 6x6 filter, rows are eight wide so extra taps hit zero coefficients
+    inline float filterNormal(const float* const* p, int phaseX, int phaseY) const
+    {
+        auto acc = Ops::zero();
+        for (int i = 0; i < 6; i++)
+        {
+            acc = Ops::madd(Ops::load(p[i]), coef.scale[phaseY][i], acc);
+        }
+        return Ops::dot(acc, coef.scale[phaseX]);
+    }
+
+    inline float addDirFilters(const float* const* p, float fx, float fy, int phaseX, int phaseY, const Float4& w) const
+    {
+        alignas(32) float interp[8]{};
+        float f = 0;
+        if (w.x > 0.0f)
+        {
+            // 0 deg filter
+            for (int i = 0; i < 6; i++)
+            {
+                interp[i] = lerp(p[i][2], p[i][3], fx);
+            }
+            f += evalPoly6(interp, phaseY) * w.x;
+        }
+        if (w.y > 0.0f)
+        {
+            // 90 deg filter
+            for (int i = 0; i < 6; i++)
+            {
+                interp[i] = lerp(p[2][i], p[3][i], fy);
+            }
+            f += evalPoly6(interp, phaseX) * w.y;
+        }
+        if (w.z > 0.0f)
+        {
+            // 45 deg filter
+            float phase = 0.5f + 0.5f * (fx - fy);
+            float temp[7];
+            temp[1] = lerp(p[2][1], p[1][2], phase);
+            temp[3] = lerp(p[3][2], p[2][3], phase);
+            temp[5] = lerp(p[4][3], p[3][4], phase);
+            phase = phase - 0.5f;
+            const bool positive = phase >= 0.0f;
+            const float t = fabsf(phase);
+            temp[0] = lerp(p[1][1], positive ? p[0][2] : p[2][0], t);
+            temp[2] = lerp(p[2][2], positive ? p[1][3] : p[3][1], t);
+            temp[4] = lerp(p[3][3], positive ? p[2][4] : p[4][2], t);
+            temp[6] = lerp(p[4][4], positive ? p[3][5] : p[5][3], t);
+
+            float phaseP45 = fx + fy;
+            const int offset = phaseP45 >= 1 ? 1 : 0;
+            phaseP45 -= offset;
+            for (int i = 0; i < 6; i++)
+            {
+                interp[i] = temp[i + offset];
+            }
+            f += evalPoly6(interp, int(phaseP45 * 64)) * w.z;
+        }
+        if (w.w > 0.0f)
+        {
+            // 135 deg filter
+            float phase = 0.5f * (fx + fy);
+            float temp[7];
+            temp[1] = lerp(p[3][1], p[4][2], phase);
+            temp[3] = lerp(p[2][2], p[3][3], phase);
+            temp[5] = lerp(p[1][3], p[2][4], phase);
+            phase = phase - 0.5f;
+            const bool positive = phase >= 0.0f;
+            const float t = fabsf(phase);
+            temp[0] = lerp(p[4][1], positive ? p[5][2] : p[3][0], t);
+            temp[2] = lerp(p[3][2], positive ? p[4][3] : p[2][1], t);
+            temp[4] = lerp(p[2][3], positive ? p[3][4] : p[1][2], t);
+            temp[6] = lerp(p[1][4], positive ? p[2][5] : p[0][3], t);
+
+            float phaseP135 = 1 + (fx - fy);
+            const int offset = phaseP135 >= 1 ? 1 : 0;
+            phaseP135 -= offset;
+            for (int i = 0; i < 6; i++)
+            {
+                interp[i] = temp[i + offset];
+            }
+            f += evalPoly6(interp, int(phaseP135 * 64)) * w.w;
+        }
+        return f;
+    }
+
+    inline const Float4& edge(int x, int y) const { return edges[size_t(y + 1) * edgePitch + x + 1]; }
+
+    void run(const Image& input, const Image& output)
+    {
+        const int inWidth = int(c.kInputViewportWidth);
+        const int inHeight = int(c.kInputViewportHeight);
+        luma.build<kHDRMode>(input, int(c.kInputViewportOriginX), int(c.kInputViewportOriginY), inWidth, inHeight);
+
+        edgePitch = inWidth + 2;
+        edges.resize(size_t(edgePitch) * (inHeight + 2));
+        for (int y = -1; y <= inHeight; y++)
+        {
+            const float* r0 = luma.row(y - 1) - 1;
+            const float* r1 = luma.row(y) - 1;
+            const float* r2 = luma.row(y + 1) - 1;
+            auto dst = edges.data() + size_t(y + 1) * edgePitch;
+            for (int x = -1; x <= inWidth; x++)
+            {
+                dst[x + 1] = getEdgeMap(c, r0 + x, r1 + x, r2 + x);
+            }
+        }
+
+        for (uint32_t dstY = 0; dstY < c.kOutputViewportHeight; dstY++)
+        {
+            const float srcY = (0.5f + dstY) * c.kScaleY - 0.5f;
+            const float floorY = floorf(srcY);
+            const int iy = int(floorY);
+            const float fy = srcY - floorY;
+            const int fyInt = int(fy * kPhaseCount);
+
+            auto dst = output.data + (size_t(c.kOutputViewportOriginY + dstY) * output.pitch + c.kOutputViewportOriginX) * 4;
+            for (uint32_t dstX = 0; dstX < c.kOutputViewportWidth; dstX++, dst += 4)
+            {
+                const float srcX = (0.5f + dstX) * c.kScaleX - 0.5f;
+                const float floorX = floorf(srcX);
+                const int ix = int(floorX);
+                const float fx = srcX - floorX;
+                const int fxInt = int(fx * kPhaseCount);
+
+                // weights for directional filters
+                const Float4 h0 = lerp(edge(ix, iy), edge(ix + 1, iy), fx);
+                const Float4 h1 = lerp(edge(ix, iy + 1), edge(ix + 1, iy + 1), fx);
+                const Float4 w = lerp(h0, h1, fy);
+
+                // 6x6 support
+                const float* p[6];
+                for (int i = 0; i < 6; i++)
+                {
+                    p[i] = luma.row(iy - 2 + i) + ix - 2;
+                }
+
+                const float baseWeight = 1.0f - w.x - w.y - w.z - w.w;
+                float opY = filterNormal(p, fxInt, fyInt) * baseWeight;
+                opY += addDirFilters(p, fx, fy, fxInt, fyInt, w);
+
+                // bilinear tap for chroma
+                float op[4];
+                sampleBilinear(input, srcX + c.kInputViewportOriginX, srcY + c.kInputViewportOriginY, op);
+                if constexpr (kHDRMode == NISHDRMode::Linear)
+                {
+                    const float kEps = 1e-4f;
+                    const float kNorm = 1.0f / kHDRCompression;
+                    const float opYN = std::max(opY, 0.0f) * kNorm;
+                    const float corr = (opYN * opYN + kEps) / (std::max(getYLinear(op), 0.0f) + kEps);
+                    op[0] *= corr;
+                    op[1] *= corr;
+                    op[2] *= corr;
+                }
+                else
+                {
+                    const float corr = opY - getY<kHDRMode>(op);
+                    op[0] += corr;
+                    op[1] += corr;
+                    op[2] += corr;
+                }
+                memcpy(dst, op, sizeof(op));
+            }
+        }
+    }
+};
+
+//! NVSharpen, uses a fixed USM profile and 5x5 support
+template<NISHDRMode kHDRMode>
+struct Sharpener
+{
+    explicit Sharpener(const NISConfig& config) : c(config) {}
+
+    const NISConfig& c;
+    LumaPlane luma;
+
+    inline float calcLTIFast(const float* y) const
+    {
+        const float a_min = std::min(std::min(y[0], y[1]), y[2]);
+        const float a_max = std::max(std::max(y[0], y[1]), y[2]);
+        const float b_min = std::min(std::min(y[2], y[3]), y[4]);
+        const float b_max = std::max(std::max(y[2], y[3]), y[4]);
+        return contrastWeight(c, a_min, a_max, b_min, b_max);
+    }
+
+    inline float evalUSM(const float* pxl, float strength, float limit) const
+    {
+        float y_usm = -0.6001f * pxl[1] + 1.2002f * pxl[2] - 0.6001f * pxl[3];
+        y_usm *= strength;
+        y_usm = std::min(limit, std::max(-limit, y_usm));
+        y_usm *= calcLTIFast(pxl);
+        return y_usm;
+    }
+
+    inline Float4 getDirUSM(const float* const* p) const
+    {
+        // sharpness boost and limit are the same for all directions
+        const float scaleY = 1.0f - saturate((p[2][2] - c.kSharpStartY) * c.kSharpScaleY);
+        const float strength = scaleY * c.kSharpStrengthScale + c.kSharpStrengthMin;
+        const float limit = (scaleY * c.kSharpLimitScale + c.kSharpLimitMin) * p[2][2];
+
+        Float4 rval;
+        float interp[5];
+        for (int i = 0; i < 5; i++) interp[i] = p[i][2];
+        rval.x = evalUSM(interp, strength, limit);
+
+        for (int i = 0; i < 5; i++) interp[i] = p[2][i];
+        rval.y = evalUSM(interp, strength, limit);
+
+        interp[0] = p[1][1];
+        interp[1] = lerp(p[2][1], p[1][2], 0.5f);
+        interp[2] = p[2][2];
+        interp[3] = lerp(p[3][2], p[2][3], 0.5f);
+        interp[4] = p[3][3];
+        rval.z = evalUSM(interp, strength, limit);
+
+        interp[0] = p[3][1];
+        interp[1] = lerp(p[3][2], p[2][1], 0.5f);
+        interp[2] = p[2][2];
+        interp[3] = lerp(p[2][3], p[1][2], 0.5f);
+        interp[4] = p[1][3];
+        rval.w = evalUSM(interp, strength, limit);
+        return rval;
+    }
+
+    void run(const Image& input, const Image& output)
+    {
+        const int originX = int(c.kInputViewportOriginX);
+        const int originY = int(c.kInputViewportOriginY);
+        luma.build<kHDRMode>(input, originX, originY, int(c.kOutputViewportWidth), int(c.kOutputViewportHeight));
+
+        for (uint32_t dstY = 0; dstY < c.kOutputViewportHeight; dstY++)
+        {
+            const int ty = std::min(originY + int(dstY), int(input.height) - 1);
+            auto src = input.data + size_t(ty) * input.pitch * 4;
+            auto dst = output.data + (size_t(c.kOutputViewportOriginY + dstY) * output.pitch + c.kOutputViewportOriginX) * 4;
+            for (uint32_t dstX = 0; dstX < c.kOutputViewportWidth; dstX++, dst += 4)
+            {
+                // 5x5 support
+                const float* p[5];
+                for (int i = 0; i < 5; i++)
+                {
+                    p[i] = luma.row(int(dstY) - 2 + i) + int(dstX) - 2;
+                }
+
+                const Float4 dirUSM = getDirUSM(p);
+                const Float4 w = getEdgeMap(c, p[1] + 1, p[2] + 1, p[3] + 1);
+                const float usmY = dirUSM.x * w.x + dirUSM.y * w.y + dirUSM.z * w.z + dirUSM.w * w.w;
+
+                const int tx = std::min(originX + int(dstX), int(input.width) - 1);
+                float op[4];
+                memcpy(op, src + size_t(tx) * 4, sizeof(op));
+                if constexpr (kHDRMode == NISHDRMode::Linear)
+                {
+                    const float kEps = 1e-4f * kHDRCompression * kHDRCompression;
+                    const float newY = std::max(p[2][2] + usmY, 0.0f);
+                    const float oldY = p[2][2];
+                    const float corr = (newY * newY + kEps) / (oldY * oldY + kEps);
+                    op[0] *= corr;
+                    op[1] *= corr;
+                    op[2] *= corr;
+                }
+                else
+                {
+                    op[0] += usmY;
+                    op[1] += usmY;
+                    op[2] += usmY;
+                }
+                memcpy(dst, op, sizeof(op));
+            }
+        }
+    }
+};
+
+bool validate(const NISConfig& config, const Image& input, const Image& output)
+{
+    if (!input.data || !output.data || input.pitch < input.width || output.pitch < output.width)
+    {
+        SL_NIS_CPU_LOG_ERROR("Invalid NIS CPU input or output image");
+        return false;
+    }
+    if (config.kInputViewportWidth == 0 || config.kInputViewportHeight == 0 ||
+        config.kInputViewportOriginX + config.kInputViewportWidth > input.width ||
+        config.kInputViewportOriginY + config.kInputViewportHeight > input.height ||
+        config.kOutputViewportOriginX + config.kOutputViewportWidth > output.width ||
+        config.kOutputViewportOriginY + config.kOutputViewportHeight > output.height)
+    {
+        SL_NIS_CPU_LOG_ERROR("NIS CPU viewport does not fit the provided images");
+        return false;
+    }
+    return true;
+}
+
+template<typename Ops>
+void runScaler(const NISConfig& config, const Options& options, const Image& input, const Image& output)
+{
+    auto& coef = getCoefficients(options.precision);
+    switch (options.hdrMode)
+    {
+        case NISHDRMode::Linear: Scaler<NISHDRMode::Linear, Ops>(config, coef).run(input, output); break;
+        case NISHDRMode::PQ: Scaler<NISHDRMode::PQ, Ops>(config, coef).run(input, output); break;
+        default: Scaler<NISHDRMode::None, Ops>(config, coef).run(input, output); break;
+    }
+}
+
+}
+
+bool isSIMDAvailable()
+{
+#if SL_NIS_CPU_RUNTIME_CHECK
+    static const bool s_avx2 = []()->bool
+    {
+        int info[4]{};
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        // AVX and OSXSAVE, then make sure OS saves YMM registers on context switch
+        __cpuid(info, 1);
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) return false;
+        if ((_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }();
+    return s_avx2;
+#elif SL_NIS_CPU_AVX2 || SL_NIS_CPU_NEON
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool scale(const NISConfig& config, const Options& options, const Image& input, const Image& output)
+{
+    if (!validate(config, input, output)) return false;
+
+#if SL_NIS_CPU_AVX2 || SL_NIS_CPU_NEON
+    if (!options.forceScalar && isSIMDAvailable())
+    {
+        runScaler<SIMDOps>(config, options, input, output);
+        return true;
+    }
+#endif
+    runScaler<ScalarOps>(config, options, input, output);
+    return true;
+}
+
+bool sharpen(const NISConfig& config, const Options& options, const Image& input, const Image& output)
+{
+    if (!validate(config, input, output)) return false;
+    if (config.kInputViewportWidth != config.kOutputViewportWidth || config.kInputViewportHeight != config.kOutputViewportHeight)
+    {
+        SL_NIS_CPU_LOG_ERROR("NIS CPU sharpen requires matching input and output viewports");
+        return false;
+    }
+
+    switch (options.hdrMode)
+    {
+        case NISHDRMode::Linear: Sharpener<NISHDRMode::Linear>(config).run(input, output); break;
+        case NISHDRMode::PQ: Sharpener<NISHDRMode::PQ>(config).run(input, output); break;
+        default: Sharpener<NISHDRMode::None>(config).run(input, output); break;
+    }
+    return true;
+}
+
+}
+}
+}
@@ -0,0 +1,88 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "./NIS/NIS_Config.h"
+
+namespace sl
+{
+
+namespace nis
+{
+
+//! CPU implementation of NVScaler and NVSharpen from NIS/NIS_Scaler.h
+//!
+//! Consumes the same NISConfig constants and coefficient tables as the compute shaders
+//! so it can be used as a reference for the GPU path or for headless/offline processing.
+//! Linear clamp sampling and viewports behave like the shader variant compiled
+//! with NIS_VIEWPORT_SUPPORT=1.
+namespace cpu
+{
+
+//! Selects which copy of the coefficient tables from NIS_Config.h is used,
+//! fp16 tables are expanded to fp32 once and match what the GPU sees with half precision coefficient textures
+enum class CoefficientPrecision : uint32_t
+{
+    eFP32,
+    eFP16
+};
+
+//! Four floats per pixel in RGBA order, pitch is in pixels
+//!
+//! Output values are not clamped, same as the shader writing to a float UAV.
+struct Image
+{
+    float* data{};
+    uint32_t width{};
+    uint32_t height{};
+    uint32_t pitch{};
+};
+
+struct Options
+{
+    NISHDRMode hdrMode = NISHDRMode::None;
+    CoefficientPrecision precision = CoefficientPrecision::eFP32;
+    //! Use scalar code even if AVX2 or NEON path is available
+    bool forceScalar = false;
+};
+
+//! Upscales input viewport to output viewport, config must be obtained from NVScalerUpdateConfig
+bool scale(const NISConfig& config, const Options& options, const Image& input, const Image& output);
+
+//! Sharpen only path, config must be obtained from NVSharpenUpdateConfig
+//!
+//! USM profile is built into the algorithm so coefficient precision has no effect here.
+bool sharpen(const NISConfig& config, const Options& options, const Image& input, const Image& output);
+
+//! Returns true if SIMD path was compiled in and the CPU supports it
+bool isSIMDAvailable();
+
+//! Exported by sl.nis through 'slGetPluginFunction' as "slNISScaleCPU" and "slNISSharpenCPU"
+//!
+//! No device or plugin manager is needed so headless/offline tools can load the plugin and call these directly.
+using PFunScale = bool(const NISConfig& config, const Options& options, const Image& input, const Image& output);
+using PFunSharpen = bool(const NISConfig& config, const Options& options, const Image& input, const Image& output);
+
+}
+}
+}
@@ -0,0 +1,172 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <vector>
+
+#include "source/core/sl.log/log.h"
+#include "source/core/sl.extra/extra.h"
+#include "source/plugins/sl.nis/nisCoefficients.h"
+
+namespace sl
+{
+
+namespace nis
+{
+
+bool CoefficientManager::acquire(chi::ICompute* compute, chi::CommandList cmdList, CoefficientPrecision precision, CoefficientTextures& textures)
+{
+    chi::Device device{};
+    CHI_CHECK_RF(compute->getDevice(device));
+
+    std::scoped_lock lock(m_mtx);
+    auto& entry = m_entries[{ device, precision }];
+    if (!entry.refCount)
+    {
+        if (!create(compute, cmdList, precision, entry.textures))
+        {
+            m_entries.erase({ device, precision });
+            return false;
+        }
+    }
+    entry.refCount++;
+    textures = entry.textures;
+    return true;
+}
+
+void CoefficientManager::release(chi::ICompute* compute, CoefficientPrecision precision)
+{
+    chi::Device device{};
+    if (compute->getDevice(device) != chi::ComputeStatus::eOk) return;
+
+    std::scoped_lock lock(m_mtx);
+    auto it = m_entries.find({ device, precision });
+    if (it == m_entries.end()) return;
+    if (--(*it).second.refCount == 0)
+    {
+        destroy(compute, (*it).second.textures);
+        m_entries.erase(it);
+    }
+}
+
+void CoefficientManager::releaseDevice(chi::ICompute* compute)
+{
+    chi::Device device{};
+    if (compute->getDevice(device) != chi::ComputeStatus::eOk) return;
+
+    std::scoped_lock lock(m_mtx);
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        if ((*it).first.first == device)
+        {
+            destroy(compute, (*it).second.textures);
+            it = m_entries.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
+uint64_t CoefficientManager::getVRAMUsage(chi::ICompute* compute)
+{
+    chi::Device device{};
+    if (compute->getDevice(device) != chi::ComputeStatus::eOk) return 0;
+
+    uint64_t bytes = 0;
+    std::scoped_lock lock(m_mtx);
+    for (auto& [key, entry] : m_entries)
+    {
+        if (key.first != device) continue;
+        chi::ResourceFootprint footprint{};
+        compute->getResourceFootprint(entry.textures.scaler, footprint);
+        bytes += footprint.totalBytes;
+        compute->getResourceFootprint(entry.textures.usm, footprint);
+        bytes += footprint.totalBytes;
+    }
+    return bytes;
+}
+
+bool CoefficientManager::create(chi::ICompute* compute, chi::CommandList cmdList, CoefficientPrecision precision, CoefficientTextures& textures)
+{
+    const bool fp16 = precision == CoefficientPrecision::eFP16;
+    const uint32_t elementSize = fp16 ? sizeof(uint16_t) : sizeof(float);
+
+    auto texDesc = chi::ResourceDescription(uint32_t(kFilterSize / 4), uint32_t(kPhaseCount), fp16 ? chi::eFormatRGBA16F : chi::eFormatRGBA32F);
+    if (compute->createTexture2D(texDesc, textures.scaler, "nisScalerCoef") != chi::ComputeStatus::eOk ||
+        compute->createTexture2D(texDesc, textures.usm, "nisUSMCoef") != chi::ComputeStatus::eOk)
+    {
+        SL_LOG_ERROR("Failed to create NIS coefficient textures");
+        destroy(compute, textures);
+        return false;
+    }
+
+    uint32_t rowPitchAlignment = 1; // D3D11
+    RenderAPI platform;
+    compute->getRenderAPI(platform);
+    if (platform == RenderAPI::eD3D12)
+    {
+        rowPitchAlignment = 256; // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+    }
+
+    const uint32_t rowPitch = uint32_t(kFilterSize) * elementSize;
+    const uint32_t deviceRowPitch = extra::align(rowPitch, rowPitchAlignment);
+    const uint32_t totalBytes = deviceRowPitch * uint32_t(kPhaseCount);
+
+    std::vector<uint8_t> blob(totalBytes);
+    auto upload = [&](const void* data, chi::Resource target, const char* name)->bool
+    {
+        for (uint32_t row = 0; row < kPhaseCount; row++)
+        {
+            memcpy(blob.data() + deviceRowPitch * row, (const uint8_t*)data + rowPitch * row, rowPitch);
+        }
+        chi::Resource uploadBuffer{};
+        chi::ResourceDescription bufferDesc(totalBytes, 1, chi::eFormatINVALID, chi::HeapType::eHeapTypeUpload, chi::ResourceState::eUnknown);
+        if (compute->createBuffer(bufferDesc, uploadBuffer, name) != chi::ComputeStatus::eOk) return false;
+        auto res = compute->copyHostToDeviceTexture(cmdList, totalBytes, rowPitch, blob.data(), target, uploadBuffer);
+        // Textures are immutable so upload buffer is never needed again, destruction is delayed until GPU is done with the copy
+        compute->destroyResource(uploadBuffer);
+        return res == chi::ComputeStatus::eOk;
+    };
+
+    if (!upload(fp16 ? (const void*)coef_scale_fp16 : (const void*)coef_scale, textures.scaler, "sl.ctx.uploadScalerCoef") ||
+        !upload(fp16 ? (const void*)coef_usm_fp16 : (const void*)coef_usm, textures.usm, "sl.ctx.uploadUsmCoef"))
+    {
+        SL_LOG_ERROR("Failed to upload NIS coefficients");
+        destroy(compute, textures);
+        return false;
+    }
+
+    SL_LOG_INFO("Created shared NIS coefficient textures (%s)", fp16 ? "fp16" : "fp32");
+    return true;
+}
+
+void CoefficientManager::destroy(chi::ICompute* compute, CoefficientTextures& textures)
+{
+    if (textures.scaler) compute->destroyResource(textures.scaler);
+    if (textures.usm) compute->destroyResource(textures.usm);
+    textures = {};
+}
+
+}
+}
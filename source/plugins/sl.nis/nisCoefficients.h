@@ -0,0 +1,81 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <map>
+#include <mutex>
+
+#include "source/platforms/sl.chi/compute.h"
+#include "source/plugins/sl.nis/nisCPU.h"
+
+namespace sl
+{
+
+namespace nis
+{
+
+using cpu::CoefficientPrecision;
+
+struct CoefficientTextures
+{
+    chi::Resource scaler{};
+    chi::Resource usm{};
+};
+
+//! Immutable coefficient textures shared by all viewports
+//!
+//! Textures are created and uploaded once per device and precision, upload buffers are
+//! handed to deferred destruction right after the copy is recorded. Each viewport holds
+//! one reference, last release destroys the textures.
+//!
+//! Thread safe
+class CoefficientManager
+{
+public:
+    //! Adds a reference, records the upload on 'cmdList' only if textures do not exist yet
+    bool acquire(chi::ICompute* compute, chi::CommandList cmdList, CoefficientPrecision precision, CoefficientTextures& textures);
+    void release(chi::ICompute* compute, CoefficientPrecision precision);
+    //! Destroys everything created on the device regardless of the outstanding references,
+    //! used when device is lost or plugin shuts down
+    void releaseDevice(chi::ICompute* compute);
+
+    uint64_t getVRAMUsage(chi::ICompute* compute);
+
+private:
+    struct Entry
+    {
+        CoefficientTextures textures{};
+        uint32_t refCount{};
+    };
+    using Key = std::pair<chi::Device, CoefficientPrecision>;
+
+    bool create(chi::ICompute* compute, chi::CommandList cmdList, CoefficientPrecision precision, CoefficientTextures& textures);
+    void destroy(chi::ICompute* compute, CoefficientTextures& textures);
+
+    std::mutex m_mtx;
+    std::map<Key, Entry> m_entries;
+};
+
+}
+}
@@ -34,6 +34,8 @@
 #include "source/core/sl.param/parameters.h"
 #include "source/platforms/sl.chi/compute.h"
 #include "source/plugins/sl.nis/versions.h"
+#include "source/plugins/sl.nis/nisCoefficients.h"
+#include "source/plugins/sl.nis/nisCPU.h"
 #include "source/plugins/sl.imgui/imgui.h"
 #include "source/plugins/sl.common/commonInterface.h"
 #include "external/json/include/nlohmann/json.hpp"
@@ -53,6 +55,8 @@ struct NISViewport
 {
     uint32_t id = {};
     NISOptions consts = {};
+    // Shared, references are owned by CoefficientManager
+    CoefficientTextures coefficients = {};
 };
 
 struct UIStats
@@ -75,10 +79,8 @@ struct NISContext
     std::map<uint32_t, NISViewport> viewports = {};
     NISViewport* currentViewport = {};
 
-    chi::Resource scalerCoef = {};
-    chi::Resource usmCoef = {};
-    chi::Resource uploadScalerCoef = {};
-    chi::Resource uploadUsmCoef = {};
+    CoefficientManager coefficientManager = {};
+    CoefficientPrecision coefficientPrecision = CoefficientPrecision::eFP32;
 
     UIStats uiStats{};
 
@@ -168,50 +170,15 @@ Result slSetData(const BaseStructure* inputs, CommandBuffer* cmdBuffer)
 bool initializeNIS(chi::CommandList cmdList, const common::EventData& data)
 {
     auto& ctx = (*nis::getContext());
-    if (!ctx.scalerCoef && !ctx.usmCoef)
+    auto& viewport = *ctx.currentViewport;
+    // Sharpen only path does not use coefficients, each viewport holds at most one reference
+    if (viewport.consts.mode == NISMode::eScaler && !viewport.coefficients.scaler)
     {
-        auto texDesc = sl::chi::ResourceDescription(kFilterSize / 4, kPhaseCount, sl::chi::eFormatRGBA32F);
-        CHI_CHECK_RF(ctx.compute->createTexture2D(texDesc, ctx.scalerCoef, "nisScalerCoef"));
-        CHI_CHECK_RF(ctx.compute->createTexture2D(texDesc, ctx.usmCoef, "nisUSMCoef"));
-
-        int rowPitchAlignment = 1; // D3D11
-        RenderAPI platform;
-        ctx.compute->getRenderAPI(platform);
-        if (platform == RenderAPI::eD3D12)
+        if (!ctx.coefficientManager.acquire(ctx.compute, cmdList, ctx.coefficientPrecision, viewport.coefficients))
         {
-            rowPitchAlignment = 256; // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+            viewport.coefficients = {};
+            return false;
         }
-
-        const int rowPitch = kFilterSize * sizeof(float);
-        const int deviceRowPitch = extra::align(kFilterSize * sizeof(float), rowPitchAlignment);
-        const int totalBytes = deviceRowPitch * kPhaseCount;
-
-        if (!ctx.uploadScalerCoef)
-        {
-            chi::ResourceDescription bufferDesc(deviceRowPitch * kPhaseCount, 1, chi::eFormatINVALID, chi::HeapType::eHeapTypeUpload, chi::ResourceState::eUnknown);
-            CHI_CHECK_RF(ctx.compute->createBuffer(bufferDesc, ctx.uploadScalerCoef, "sl.ctx.uploadScalerCoef"));
-            CHI_CHECK_RF(ctx.compute->createBuffer(bufferDesc, ctx.uploadUsmCoef, "sl.ctx.uploadUsmCoef"));
-        }
-
-        std::vector<float> blobScale(totalBytes / sizeof(float));
-        std::vector<float> blobUsm(totalBytes / sizeof(float));
-
-        auto fillBlob = [rowPitch, deviceRowPitch](std::vector<float>& blob, const void* data)->void
-        {
-            void* cpuVA = blob.data();
-            for (uint32_t row = 0; row < kPhaseCount; row++)
-            {
-                void* destAddress = (char*)cpuVA + deviceRowPitch * row;
-                void* srcAddress = (char*)data + rowPitch * row;
-                memcpy(destAddress, srcAddress, rowPitch);
-            }
-        };
-
-        fillBlob(blobScale, coef_scale);
-        fillBlob(blobUsm, coef_usm);
-
-        CHI_CHECK_RF(ctx.compute->copyHostToDeviceTexture(cmdList, totalBytes, rowPitch, blobScale.data(), ctx.scalerCoef, ctx.uploadScalerCoef));
-        CHI_CHECK_RF(ctx.compute->copyHostToDeviceTexture(cmdList, totalBytes, rowPitch, blobUsm.data(), ctx.usmCoef, ctx.uploadUsmCoef));
     }
     return true;
 }
@@ -232,7 +199,11 @@ Result nisBeginEvaluation(chi::CommandList cmdList, const common::EventData& dat
     viewport.consts = *consts;
     ctx.currentViewport = &viewport;
 
-    initializeNIS(cmdList, data);
+    if (!initializeNIS(cmdList, data))
+    {
+        ctx.currentViewport = {};
+        return Result::eErrorInvalidState;
+    }
     return Result::eOk;
 }
 
@@ -341,8 +312,15 @@ Result nisEndEvaluation(chi::CommandList cmdList, const common::EventData& data,
     CHI_VALIDATE(ctx.compute->bindRWTexture(3, 0, colorOut));
     if (consts.mode == NISMode::eScaler)
     {
-        CHI_VALIDATE(ctx.compute->bindTexture(4, 1, ctx.scalerCoef));
-        CHI_VALIDATE(ctx.compute->bindTexture(5, 2, ctx.usmCoef));
+        auto& coefficients = ctx.currentViewport->coefficients;
+        if (!coefficients.scaler)
+        {
+            // Mode can only change via slSetData between begin and end evaluation
+            SL_LOG_ERROR("Missing NIS coefficients for viewport %u", id);
+            return Result::eErrorInvalidState;
+        }
+        CHI_VALIDATE(ctx.compute->bindTexture(4, 1, coefficients.scaler));
+        CHI_VALIDATE(ctx.compute->bindTexture(5, 2, coefficients.usm));
     }
     CHI_VALIDATE(ctx.compute->dispatch(UINT(std::ceil(outDesc.width / float(ctx.blockWidth))), UINT(std::ceil(outDesc.height / float(ctx.blockHeight))), 1));
 
@@ -505,16 +483,9 @@ void slOnPluginShutdown()
     // it will shutdown it down automatically
     plugin::onShutdown(api::getContext());
 
-    if (ctx.uploadScalerCoef)
-    {
-        ctx.compute->destroyResource(ctx.uploadScalerCoef);
-    }
-    if (ctx.uploadUsmCoef)
-    {
-        ctx.compute->destroyResource(ctx.uploadUsmCoef);
-    }
-    ctx.compute->destroyResource(ctx.scalerCoef);
-    ctx.compute->destroyResource(ctx.usmCoef);
+    // Device is going away, drop shared textures even if viewports were never freed
+    ctx.coefficientManager.releaseDevice(ctx.compute);
+    ctx.viewports.clear();
 
     for (auto& e : ctx.shaders)
     {
@@ -523,6 +494,28 @@ void slOnPluginShutdown()
     ctx.compute = {};
 }
 
+//! Explicit de-allocation of resources
+Result slFreeResources(Feature feature, const sl::ViewportHandle& viewport)
+{
+    auto& ctx = (*nis::getContext());
+    auto it = ctx.viewports.find(viewport);
+    if (it == ctx.viewports.end())
+    {
+        return Result::eErrorInvalidParameter;
+    }
+    if ((*it).second.coefficients.scaler)
+    {
+        ctx.coefficientManager.release(ctx.compute, ctx.coefficientPrecision);
+    }
+    // Do not leave a dangling pointer for the next evaluate or UI pass
+    if (ctx.currentViewport == &(*it).second)
+    {
+        ctx.currentViewport = {};
+    }
+    ctx.viewports.erase(it);
+    return Result::eOk;
+}
+
 sl::Result slNISSetOptions(const sl::ViewportHandle& viewport, const sl::NISOptions& options)
 {
     auto v = viewport;
@@ -535,36 +528,43 @@ sl::Result slNISGetState(const sl::ViewportHandle& viewport, sl::NISState& state
     auto& ctx = (*nis::getContext());
     if (!ctx.compute) return Result::eErrorInvalidState;
 
-    state.estimatedVRAMUsageInBytes = 0;
-
-    chi::ResourceFootprint footprint{};
-    ctx.compute->getResourceFootprint(ctx.uploadScalerCoef, footprint);
-    state.estimatedVRAMUsageInBytes += footprint.totalBytes;
-    ctx.compute->getResourceFootprint(ctx.uploadUsmCoef, footprint);
-    state.estimatedVRAMUsageInBytes += footprint.totalBytes;
-    ctx.compute->getResourceFootprint(ctx.scalerCoef, footprint);
-    state.estimatedVRAMUsageInBytes += footprint.totalBytes;
-    ctx.compute->getResourceFootprint(ctx.usmCoef, footprint);
-    state.estimatedVRAMUsageInBytes += footprint.totalBytes;
+    // Coefficients are shared by all viewports so this is the same regardless of the viewport
+    state.estimatedVRAMUsageInBytes = ctx.coefficientManager.getVRAMUsage(ctx.compute);
 
     return Result::eOk;
 }
 
+//! CPU path needs no device, see nisCPU.h
+bool slNISScaleCPU(const NISConfig& config, const nis::cpu::Options& options, const nis::cpu::Image& input, const nis::cpu::Image& output)
+{
+    return nis::cpu::scale(config, options, input, output);
+}
+
+bool slNISSharpenCPU(const NISConfig& config, const nis::cpu::Options& options, const nis::cpu::Image& input, const nis::cpu::Image& output)
+{
+    return nis::cpu::sharpen(config, options, input, output);
+}
+
 SL_EXPORT void *slGetPluginFunction(const char *functionName)
 {
     // Forward declarations
     bool slOnPluginLoad(sl::param::IParameters * params, const char* loaderJSON, const char** pluginJSON);
+    bool slOnPluginSetLoaderConfig(const void* config, size_t size);
 
     //! Redirect to OTA if any
     SL_EXPORT_OTA;
 
     // Core API
     SL_EXPORT_FUNCTION(slOnPluginLoad);
+    SL_EXPORT_FUNCTION(slOnPluginSetLoaderConfig);
     SL_EXPORT_FUNCTION(slOnPluginShutdown);
     SL_EXPORT_FUNCTION(slOnPluginStartup);
     SL_EXPORT_FUNCTION(slSetData);
+    SL_EXPORT_FUNCTION(slFreeResources);
     SL_EXPORT_FUNCTION(slNISSetOptions);
     SL_EXPORT_FUNCTION(slNISGetState);
+    SL_EXPORT_FUNCTION(slNISScaleCPU);
+    SL_EXPORT_FUNCTION(slNISSharpenCPU);
 
     return nullptr;
 }
@@ -25,6 +25,7 @@
 #include <atomic>
 #include <future>
 #include <vector>
+#include <array>
 
 #include "include/sl.h"
 #include "include/sl_helpers.h"
@@ -34,6 +35,7 @@
 #include "source/core/sl.plugin/plugin.h"
 #include "source/core/sl.file/file.h"
 #include "source/core/sl.extra/extra.h"
+#include "source/core/sl.extra/arena.h"
 #include "source/core/sl.param/parameters.h"
 #include "source/core/sl.security/secureLoadLibrary.h"
 #include "external/json/include/nlohmann/json.hpp"
@@ -546,6 +548,50 @@ struct NRDInstance
         return chi::ResourceState::eUnknown;
     }
     std::vector<chi::Kernel> shaders;
+
+    //! Binding programs, compiled once from nrd::InstanceDesc since pipeline layouts never change
+    struct SamplerBinding
+    {
+        uint32_t binding;
+        uint32_t registerIndex;
+        chi::Sampler sampler;
+    };
+    struct ResourceBinding
+    {
+        uint32_t registerIndex;
+        nrd::DescriptorType type;
+        chi::ResourceState state;
+    };
+    struct BindingProgram
+    {
+        uint32_t offset;
+        uint32_t count;
+    };
+    std::vector<SamplerBinding> samplerBindings;
+    //! Bindings of all pipelines back to back, indexed by BindingProgram
+    std::vector<ResourceBinding> resourceBindings;
+    std::vector<BindingProgram> bindingPrograms;
+    uint32_t constantBufferRegisterIndex{};
+    uint32_t constantBufferMaxDataSize{};
+
+    //! Per frame scratch, tagged resources are resolved once per frame instead of once per dispatch
+    struct TaggedResource
+    {
+        CommonResource resource;
+        Result status;
+        bool resolved;
+    };
+    std::array<TaggedResource, kNrdInputBufferTagCount + kNrdOutputBufferTagCount> taggedResources{};
+    std::vector<chi::ResourceTransition> transitions;
+
+    void resetTaggedResources()
+    {
+        for (auto& tagged : taggedResources)
+        {
+            tagged.resolved = false;
+        }
+    }
+
     nrd::Instance* denoiser = {};
     uint32_t methodMask = 0;
     nrd::DenoiserDesc denoiserDescs[6];
@@ -809,6 +855,49 @@ void destroyNRD()
     CHI_VALIDATE(ctx.compute->destroyKernel(ctx.packDataKernel));
 }
 
+void buildBindingPrograms(NRDInstance* inst, const nrd::InstanceDesc& instanceDesc)
+{
+    inst->samplerBindings.clear();
+    for (uint32_t samplerID = 0; samplerID < instanceDesc.samplersNum; ++samplerID)
+    {
+        chi::Sampler sampler{};
+        switch (instanceDesc.samplers[samplerID])
+        {
+        case nrd::Sampler::NEAREST_CLAMP: sampler = chi::Sampler::eSamplerPointClamp; break;
+        case nrd::Sampler::NEAREST_MIRRORED_REPEAT: sampler = chi::Sampler::eSamplerPointMirror; break;
+        case nrd::Sampler::LINEAR_CLAMP: sampler = chi::Sampler::eSamplerLinearClamp; break;
+        case nrd::Sampler::LINEAR_MIRRORED_REPEAT: sampler = chi::Sampler::eSamplerLinearMirror; break;
+        default: SL_LOG_ERROR("Unknown sampler detected"); continue;
+        }
+        inst->samplerBindings.push_back({ samplerID, instanceDesc.samplersBaseRegisterIndex + samplerID, sampler });
+    }
+
+    inst->resourceBindings.clear();
+    inst->bindingPrograms.resize(instanceDesc.pipelinesNum);
+    uint32_t maxBindings = 0;
+    for (uint32_t pipelineID = 0; pipelineID < instanceDesc.pipelinesNum; ++pipelineID)
+    {
+        const nrd::PipelineDesc& pipeline = instanceDesc.pipelines[pipelineID];
+        auto& program = inst->bindingPrograms[pipelineID];
+        program.offset = (uint32_t)inst->resourceBindings.size();
+        for (uint32_t descriptorRangeID = 0; descriptorRangeID < pipeline.resourceRangesNum; ++descriptorRangeID)
+        {
+            const nrd::ResourceRangeDesc& descriptorRange = pipeline.resourceRanges[descriptorRangeID];
+            auto state = descriptorRange.descriptorType == nrd::DescriptorType::TEXTURE ? chi::ResourceState::eTextureRead : chi::ResourceState::eStorageRW;
+            for (uint32_t descriptorID = 0; descriptorID < descriptorRange.descriptorsNum; ++descriptorID)
+            {
+                inst->resourceBindings.push_back({ descriptorRange.baseRegisterIndex + descriptorID, descriptorRange.descriptorType, state });
+            }
+        }
+        program.count = (uint32_t)inst->resourceBindings.size() - program.offset;
+        maxBindings = std::max(maxBindings, program.count);
+    }
+
+    inst->constantBufferRegisterIndex = instanceDesc.constantBufferRegisterIndex;
+    inst->constantBufferMaxDataSize = instanceDesc.constantBufferMaxDataSize;
+    inst->transitions.reserve(maxBindings);
+}
+
 Result initializeNRD(chi::CommandList cmdList, const common::EventData& data, const sl::BaseStructure** inputs, uint32_t numInputs)
 {
     auto& ctx = (*nrdsl::getContext());
@@ -996,6 +1085,8 @@ Result initializeNRD(chi::CommandList cmdList, const common::EventData& data, co
         }
     }
 
+    buildBindingPrograms(ctx.viewport->instance, instanceDesc);
+
     chi::ResourceDescription texDesc = {};
     texDesc.width = ctx.viewport->width;
     texDesc.height = ctx.viewport->height;
@@ -1129,9 +1220,9 @@ sl::Result prepare_data(sl::nrdsl::NRDContext& ctx, CommonResourcePack pack, chi
     // Pack
     {
         extra::ScopedTasks transitions;
-        std::vector<chi::ResourceTransition> trans{
+        std::pmr::vector<chi::ResourceTransition> trans({
             {pack.normalRoughness, chi::ResourceState::eTextureRead, ctx.cachedStates[pack.normalRoughness]},
-        };
+        }, extra::getFrameArena());
 
         for (auto& resource : ctx.viewport->inputs)
         {
@@ -1279,6 +1370,43 @@ sl::Result get_resource_info(
     return sl::Result::eErrorInvalidParameter;
 }
 
+//! Returns resource to bind, pool textures are used as is and tagged ones are resolved at most once per frame
+chi::Resource nrdResolveResource(
+    sl::nrdsl::NRDContext& ctx,
+    nrd::ResourceDesc const& resourceDesc,
+    const sl::BaseStructure** inputs,
+    uint32_t numInputs)
+{
+    auto instance = ctx.viewport->instance;
+    if (resourceDesc.type == nrd::ResourceType::TRANSIENT_POOL)
+    {
+        return instance->transientTextures[resourceDesc.indexInPool];
+    }
+    if (resourceDesc.type == nrd::ResourceType::PERMANENT_POOL)
+    {
+        return instance->permanentTextures[resourceDesc.indexInPool];
+    }
+
+    auto index = static_cast<uint32_t>(resourceDesc.type);
+    if (index >= instance->taggedResources.size())
+    {
+        SL_LOG_ERROR("Unable to find texture for nrd::ResourceType %u", resourceDesc.type);
+        return {};
+    }
+    auto& tagged = instance->taggedResources[index];
+    if (!tagged.resolved)
+    {
+        tagged.resource = {};
+        tagged.status = get_resource_info(ctx, resourceDesc, inputs, numInputs, tagged.resource);
+        tagged.resolved = true;
+    }
+    if (tagged.status != Result::eOk)
+    {
+        SL_LOG_ERROR("Unable to find texture for nrd::ResourceType %u", resourceDesc.type);
+    }
+    return tagged.resource;
+}
+
 Result nrdDispatch(
     sl::nrdsl::NRDContext& ctx, 
     chi::CommandList cmdList,  
@@ -1286,83 +1414,54 @@ Result nrdDispatch(
     const sl::BaseStructure** inputs, uint32_t numInputs,
     uint32_t dispatchDescNum)
 {
-    const nrd::InstanceDesc& denoiserDesc = ctx.getInstanceDesc(*ctx.viewport->instance->denoiser);
-    const nrd::PipelineDesc& pipeline = denoiserDesc.pipelines[dispatch.pipelineIndex];
+    auto instance = ctx.viewport->instance;
+    const auto& program = instance->bindingPrograms[dispatch.pipelineIndex];
 
-    extra::ScopedTasks reverseTransitions;
-    std::vector<chi::ResourceTransition> transitions;
-    std::vector<CommonResource> commonResources;
-    commonResources.reserve(32);
+    CHI_VALIDATE(ctx.compute->bindKernel(instance->shaders[dispatch.pipelineIndex]));
 
-    CHI_VALIDATE(ctx.compute->bindKernel(ctx.viewport->instance->shaders[dispatch.pipelineIndex]));
-
-    for (uint32_t samplerID = 0; samplerID < denoiserDesc.samplersNum; ++samplerID)
+    for (const auto& sampler : instance->samplerBindings)
     {
-        switch (denoiserDesc.samplers[samplerID])
-        {
-        case nrd::Sampler::NEAREST_CLAMP:
-            CHI_VALIDATE(ctx.compute->bindSampler(samplerID, denoiserDesc.samplersBaseRegisterIndex + samplerID, chi::Sampler::eSamplerPointClamp)); break;
-        case nrd::Sampler::NEAREST_MIRRORED_REPEAT:
-            CHI_VALIDATE(ctx.compute->bindSampler(samplerID, denoiserDesc.samplersBaseRegisterIndex + samplerID, chi::Sampler::eSamplerPointMirror)); break;
-        case nrd::Sampler::LINEAR_CLAMP:
-            CHI_VALIDATE(ctx.compute->bindSampler(samplerID, denoiserDesc.samplersBaseRegisterIndex + samplerID, chi::Sampler::eSamplerLinearClamp)); break;
-        case nrd::Sampler::LINEAR_MIRRORED_REPEAT:
-            CHI_VALIDATE(ctx.compute->bindSampler(samplerID, denoiserDesc.samplersBaseRegisterIndex + samplerID, chi::Sampler::eSamplerLinearMirror)); break;
-        default: SL_LOG_ERROR("Unknown sampler detected");
-        }
+        CHI_VALIDATE(ctx.compute->bindSampler(sampler.binding, sampler.registerIndex, sampler.sampler));
     }
 
-    uint32_t slot = 0, descriptorIdx = 0;
-    for (uint32_t descriptorRangeID = 0; descriptorRangeID < pipeline.resourceRangesNum; ++descriptorRangeID)
+    if (program.count != dispatch.resourcesNum)
     {
-        const nrd::ResourceRangeDesc& descriptorRange = pipeline.resourceRanges[descriptorRangeID];
-
-        for (uint32_t descriptorID = 0; descriptorID < descriptorRange.descriptorsNum; ++descriptorID)
-        {
-            if (slot >= dispatch.resourcesNum)
-            {
-                SL_LOG_ERROR("Mismatch slot and resourceNum");
-            }
+        SL_LOG_ERROR("Mismatch slot and resourceNum");
+    }
 
-            const nrd::ResourceDesc& resourceDesc = dispatch.resources[slot++];
-            if (resourceDesc.stateNeeded != descriptorRange.descriptorType)
-            {
-                SL_LOG_ERROR("Mismatch stateNeeded and descriptor type");
-            }
+    auto& transitions = instance->transitions;
+    transitions.clear();
 
-            commonResources.push_back({});
-            sl::CommonResource& resource = commonResources.back();
-            if (get_resource_info(ctx, resourceDesc, inputs, numInputs, resource) != Result::eOk)
-            {
-                SL_LOG_ERROR("Unable to find texture for nrd::ResourceType %u", resourceDesc.type);
-            }
+    uint32_t descriptorIdx = 0;
+    const uint32_t count = std::min(program.count, dispatch.resourcesNum);
+    for (uint32_t slot = 0; slot < count; ++slot)
+    {
+        const auto& binding = instance->resourceBindings[program.offset + slot];
+        const nrd::ResourceDesc& resourceDesc = dispatch.resources[slot];
+        if (resourceDesc.stateNeeded != binding.type)
+        {
+            SL_LOG_ERROR("Mismatch stateNeeded and descriptor type");
+        }
 
-            auto transition = [&ctx](nrd::ResourceDesc const& resourceDesc) -> chi::ResourceState {
-                auto from = ctx.viewport->instance->getResourceState(resourceDesc.type, resourceDesc.indexInPool);
-                auto to = resourceDesc.stateNeeded == nrd::DescriptorType::TEXTURE ? chi::ResourceState::eTextureRead : chi::ResourceState::eStorageRW;
+        chi::Resource resource = nrdResolveResource(ctx, resourceDesc, inputs, numInputs);
 
-                ctx.viewport->instance->setResourceState(to, resourceDesc.type, resourceDesc.indexInPool);
-                return from;
-            };
+        auto from = instance->getResourceState(resourceDesc.type, resourceDesc.indexInPool);
+        instance->setResourceState(binding.state, resourceDesc.type, resourceDesc.indexInPool);
 
-            chi::ResourceState resourceState = transition(resourceDesc);
-            uint32_t bindingSlot = descriptorRange.baseRegisterIndex + descriptorID;
-            if (descriptorRange.descriptorType == nrd::DescriptorType::TEXTURE)
-            {
-                // TODO: Fix binding pos for VK
-                CHI_VALIDATE(ctx.compute->bindTexture(descriptorIdx++, bindingSlot, resource, resourceDesc.mipOffset, resourceDesc.mipNum));
-                transitions.push_back(chi::ResourceTransition(resource, chi::ResourceState::eTextureRead, resourceState));
-            }
-            else
-            {
-                // TODO: Fix binding pos for VK
-                CHI_VALIDATE(ctx.compute->bindRWTexture(descriptorIdx++, bindingSlot, resource, resourceDesc.mipOffset));
-                transitions.push_back(chi::ResourceTransition(resource, chi::ResourceState::eStorageRW, resourceState));
-            }
+        if (binding.type == nrd::DescriptorType::TEXTURE)
+        {
+            // TODO: Fix binding pos for VK
+            CHI_VALIDATE(ctx.compute->bindTexture(descriptorIdx++, binding.registerIndex, resource, resourceDesc.mipOffset, resourceDesc.mipNum));
+        }
+        else
+        {
+            // TODO: Fix binding pos for VK
+            CHI_VALIDATE(ctx.compute->bindRWTexture(descriptorIdx++, binding.registerIndex, resource, resourceDesc.mipOffset));
         }
+        transitions.push_back(chi::ResourceTransition(resource, binding.state, from));
     }
 
-    CHI_VALIDATE(ctx.compute->bindConsts(descriptorIdx++, denoiserDesc.constantBufferRegisterIndex, (void*)dispatch.constantBufferData, denoiserDesc.constantBufferMaxDataSize, 3 * dispatchDescNum));
+    CHI_VALIDATE(ctx.compute->bindConsts(descriptorIdx++, instance->constantBufferRegisterIndex, (void*)dispatch.constantBufferData, instance->constantBufferMaxDataSize, 3 * dispatchDescNum));
     CHI_VALIDATE(ctx.compute->transitionResources(cmdList, transitions.data(), (uint32_t)transitions.size(), nullptr));
     CHI_VALIDATE(ctx.compute->dispatch(dispatch.gridWidth, dispatch.gridHeight, 1));
 
@@ -1378,6 +1477,7 @@ Result nrdEndEvent(chi::CommandList cmdList, const common::EventData& data, cons
     auto parameters = api::getContext()->parameters;
 
     ctx.viewport->instance->resetStateVectors();
+    ctx.viewport->instance->resetTaggedResources();
     
     {
         CHI_VALIDATE(ctx.compute->bindSharedState(cmdList));
@@ -1569,9 +1669,7 @@ bool slOnPluginStartup(const char* jsonConfig, void* device)
     }
     ctx.registerEvaluateCallbacks(kFeatureNRD, nrdBeginEvent, nrdEndEvent);
 
-    json& config = *(json*)api::getContext()->loaderConfig;
-    int appId = 0;
-    config.at("appId").get_to(appId);
+    int appId = api::getContext()->loaderConfig.getAppId();
 
     // Path where our modules are located
     wchar_t *pluginPath = {};
@@ -1629,12 +1727,14 @@ SL_EXPORT void *slGetPluginFunction(const char *functionName)
 {
     // Forward declarations
     bool slOnPluginLoad(sl::param::IParameters * params, const char* loaderJSON, const char** pluginJSON);
+    bool slOnPluginSetLoaderConfig(const void* config, size_t size);
 
     //! Redirect to OTA if any
     SL_EXPORT_OTA;
 
     // Core API
     SL_EXPORT_FUNCTION(slOnPluginLoad);
+    SL_EXPORT_FUNCTION(slOnPluginSetLoaderConfig);
     SL_EXPORT_FUNCTION(slOnPluginShutdown);
     SL_EXPORT_FUNCTION(slOnPluginStartup);
     SL_EXPORT_FUNCTION(slSetData);
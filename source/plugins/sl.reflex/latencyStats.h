@@ -0,0 +1,195 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#include "include/sl_reflex_stats.h"
+
+namespace sl
+{
+namespace reflex
+{
+
+inline uint64_t getTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//! Log-linear (HDR style) latency histogram
+//!
+//! Values are in microseconds, each power of two range is split into
+//! kSubBuckets linear buckets which gives ~3% relative precision
+//! for anything between 0us and 16s with a fixed 640 bucket array.
+//!
+//! Lock-free, any thread can add samples while another one reads percentiles.
+struct LatencyHistogram
+{
+    static constexpr uint32_t kSubBucketBits = 5;
+    static constexpr uint32_t kSubBuckets = 1 << kSubBucketBits;
+    static constexpr uint32_t kMaxValueBits = 24;
+    static constexpr uint32_t kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+    void add(uint64_t valueUs)
+    {
+        auto v = (uint32_t)std::min<uint64_t>(valueUs, (1ull << kMaxValueBits) - 1);
+        m_buckets[getBucket(v)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(v, std::memory_order_relaxed);
+        auto maxValue = m_max.load(std::memory_order_relaxed);
+        while (v > maxValue && !m_max.compare_exchange_weak(maxValue, v, std::memory_order_relaxed)) {}
+    }
+
+    //! Returns value at the given percentile (0-100), 0 if there are no samples
+    uint32_t getPercentile(double percentile) const
+    {
+        auto count = m_count.load(std::memory_order_relaxed);
+        if (!count) return 0;
+        auto target = (uint64_t)std::ceil(count * percentile / 100.0);
+        target = std::max<uint64_t>(target, 1);
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < kBucketCount; i++)
+        {
+            seen += m_buckets[i].load(std::memory_order_relaxed);
+            if (seen >= target)
+            {
+                return std::min(getBucketValue(i), m_max.load(std::memory_order_relaxed));
+            }
+        }
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    void getPercentiles(ReflexLatencyPercentiles& out) const
+    {
+        out.numSamples = m_count.load(std::memory_order_relaxed);
+        out.meanUs = out.numSamples ? uint32_t(m_sum.load(std::memory_order_relaxed) / out.numSamples) : 0;
+        out.p50Us = getPercentile(50.0);
+        out.p95Us = getPercentile(95.0);
+        out.p99Us = getPercentile(99.0);
+        out.maxUs = m_max.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    inline static uint32_t getBucket(uint32_t v)
+    {
+        if (v < kSubBuckets) return v;
+        uint32_t msb = 0;
+        for (auto tmp = v; tmp >>= 1;) msb++;
+        auto shift = msb - kSubBucketBits;
+        return shift * kSubBuckets + (v >> shift);
+    }
+
+    //! Middle of the bucket range
+    inline static uint32_t getBucketValue(uint32_t i)
+    {
+        if (i < 2 * kSubBuckets) return i;
+        auto shift = i / kSubBuckets - 1;
+        auto top = i % kSubBuckets + kSubBuckets;
+        return (top << shift) + ((1u << shift) >> 1);
+    }
+
+    std::atomic<uint32_t> m_buckets[kBucketCount]{};
+    std::atomic<uint64_t> m_count{};
+    std::atomic<uint64_t> m_sum{};
+    std::atomic<uint32_t> m_max{};
+};
+
+//! Lock-free ring with per frame marker timestamps
+//!
+//! Slot is selected by frame index, first marker for a new frame claims the slot
+//! and clears timestamps left over from the frame kReflexTimelineSize ago.
+struct MarkerTimeline
+{
+    static constexpr uint64_t kEmpty = UINT64_MAX - 1;
+    static constexpr uint64_t kBusy = UINT64_MAX;
+
+    MarkerTimeline()
+    {
+        for (auto& slot : m_slots) slot.frame.store(kEmpty);
+    }
+
+    void record(uint32_t marker, uint64_t frame, uint64_t timeUs)
+    {
+        if (marker >= kReflexTimelineMarkerCount || frame >= kEmpty) return;
+
+        auto& slot = m_slots[frame % kReflexTimelineSize];
+        auto current = slot.frame.load(std::memory_order_acquire);
+        if (current != frame)
+        {
+            // Another thread is claiming this slot or we are late and slot was recycled, drop the sample
+            if (current == kBusy || (current != kEmpty && current > frame)) return;
+            if (!slot.frame.compare_exchange_strong(current, kBusy, std::memory_order_acq_rel)) return;
+            for (auto& t : slot.timeUs) t.store(0, std::memory_order_relaxed);
+            slot.frame.store(frame, std::memory_order_release);
+
+            auto latest = m_latestFrame.load(std::memory_order_relaxed);
+            while ((latest == kEmpty || frame > latest) && !m_latestFrame.compare_exchange_weak(latest, frame, std::memory_order_relaxed)) {}
+        }
+        slot.timeUs[marker].store(timeUs, std::memory_order_relaxed);
+    }
+
+    //! Returns 0 if marker was not recorded or frame is no longer in the ring
+    uint64_t get(uint32_t marker, uint64_t frame) const
+    {
+        if (marker >= kReflexTimelineMarkerCount) return 0;
+        auto& slot = m_slots[frame % kReflexTimelineSize];
+        if (slot.frame.load(std::memory_order_acquire) != frame) return 0;
+        return slot.timeUs[marker].load(std::memory_order_relaxed);
+    }
+
+    //! Copies frames oldest first, frames which are missing are left zeroed
+    void copyTo(ReflexFrameTimeline (&out)[kReflexTimelineSize]) const
+    {
+        auto latest = m_latestFrame.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < kReflexTimelineSize; i++)
+        {
+            out[i] = {};
+            if (latest == kEmpty || latest + 1 + i < kReflexTimelineSize) continue;
+            auto frame = latest + 1 + i - kReflexTimelineSize;
+            auto& slot = m_slots[frame % kReflexTimelineSize];
+            if (slot.frame.load(std::memory_order_acquire) != frame) continue;
+            out[i].frameID = frame;
+            for (uint32_t m = 0; m < kReflexTimelineMarkerCount; m++)
+            {
+                out[i].markerTimeUs[m] = slot.timeUs[m].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> frame{};
+        std::atomic<uint64_t> timeUs[kReflexTimelineMarkerCount]{};
+    };
+
+    Slot m_slots[kReflexTimelineSize]{};
+    std::atomic<uint64_t> m_latestFrame = kEmpty;
+};
+
+}
+}
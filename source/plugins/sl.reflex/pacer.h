@@ -0,0 +1,311 @@
+/*
+* Copyright (c) 2022 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <climits>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include "include/sl_reflex.h"
+
+namespace sl
+{
+namespace reflex
+{
+
+//! Time source used by the software pacer
+//!
+//! Abstracted so the pacer can be driven by a deterministic clock
+//! when validating its behaviour outside of a running title.
+struct IPacerClock
+{
+    //! Monotonic time in microseconds
+    virtual int64_t nowUs() = 0;
+    //! Coarse OS sleep, allowed to oversleep
+    virtual void sleepUs(int64_t us) = 0;
+    //! Called in the busy-wait loop, should be as cheap as possible
+    virtual void spin() = 0;
+};
+
+struct SteadyPacerClock : IPacerClock
+{
+    SteadyPacerClock()
+    {
+#ifdef SL_WINDOWS
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+        // High resolution timers are available on Windows 10 1803+, fall back to the regular one if not
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!m_timer)
+        {
+            m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        }
+#endif
+    }
+
+    ~SteadyPacerClock()
+    {
+#ifdef SL_WINDOWS
+        if (m_timer) CloseHandle(m_timer);
+#endif
+    }
+
+    int64_t nowUs() override final
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void sleepUs(int64_t us) override final
+    {
+#ifdef SL_WINDOWS
+        if (m_timer)
+        {
+            // Negative value means relative time in 100ns units
+            LARGE_INTEGER dueTime{};
+            dueTime.QuadPart = -us * 10;
+            if (SetWaitableTimerEx(m_timer, &dueTime, 0, nullptr, nullptr, nullptr, 0))
+            {
+                WaitForSingleObject(m_timer, INFINITE);
+                return;
+            }
+        }
+#endif
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+
+    void spin() override final
+    {
+        std::this_thread::yield();
+    }
+
+private:
+#ifdef SL_WINDOWS
+    HANDLE m_timer{};
+#endif
+};
+
+//! Vendor agnostic frame limiter and latency pacer
+//!
+//! Used when NVAPI/Reflex low-latency is not available (non-NVIDIA adapters, Linux builds).
+//! Driven purely by the markers the host is already sending:
+//!
+//! - present start/end tell us if the swap-chain queue is full (present blocks) which means we are GPU bound
+//! - simulation start to present end is the CPU cost of a frame
+//! - sleep marker is where we delay the simulation thread so that work starts "just in time"
+//!
+//! Waiting is hybrid: OS sleep until we are close to the deadline, then spin the rest.
+//! Spin window adapts to the observed OS oversleep so jitter stays in the tens of microseconds.
+//!
+//! Thread safe, markers can come from any thread.
+struct Pacer
+{
+    //! Present blocking longer than this means the queue is full
+    static constexpr int64_t kPresentBlockedThresholdUs = 200;
+    //! Do not pace faster than the predicted GPU frame time minus this headroom (percentage)
+    static constexpr int64_t kGpuHeadroomPercent = 3;
+    //! Minimum and maximum spin window
+    static constexpr int64_t kMinSpinUs = 100;
+    static constexpr int64_t kMaxSpinUs = 4000;
+    //! Anything longer than this between frames is a hitch or pause, do not let it pollute the estimates
+    static constexpr int64_t kMaxFrameIntervalUs = 200000;
+
+    Pacer(IPacerClock* clock = nullptr) : m_clock(clock ? clock : &m_steadyClock) {}
+
+    void setOptions(uint32_t frameLimitUs, bool lowLatency)
+    {
+        std::scoped_lock lock(m_mtx);
+        m_frameLimitUs = frameLimitUs == UINT_MAX ? 0 : frameLimitUs;
+        m_lowLatency = lowLatency;
+    }
+
+    //! Nothing to do unless host asked for a limit or low latency
+    bool isActive()
+    {
+        std::scoped_lock lock(m_mtx);
+        return m_frameLimitUs > 0 || m_lowLatency;
+    }
+
+    void onMarker(ReflexMarker marker)
+    {
+        auto now = m_clock->nowUs();
+        std::scoped_lock lock(m_mtx);
+        switch (marker)
+        {
+            case ReflexMarker::eSimulationStart:
+                m_simStartUs = now;
+                break;
+            case ReflexMarker::ePresentStart:
+                m_presentStartUs = now;
+                break;
+            case ReflexMarker::ePresentEnd:
+                onPresentEnd(now);
+                break;
+            default:
+                break;
+        }
+    }
+
+    //! Blocks the calling (simulation) thread until next frame should start
+    //!
+    //! Returns time spent waiting in microseconds
+    int64_t sleep()
+    {
+        int64_t deadlineUs = 0;
+        {
+            std::scoped_lock lock(m_mtx);
+            auto now = m_clock->nowUs();
+            auto intervalUs = getTargetIntervalUs();
+            if (!intervalUs || !m_lastWakeUs)
+            {
+                m_lastWakeUs = now;
+                m_sleptUs = 0;
+                return 0;
+            }
+            deadlineUs = m_lastWakeUs + intervalUs;
+            if (deadlineUs <= now)
+            {
+                // Running late, keep the phase if we are within a frame otherwise restart the cadence
+                m_lastWakeUs = now - deadlineUs < intervalUs ? deadlineUs : now;
+                m_sleptUs = 0;
+                return 0;
+            }
+            m_lastWakeUs = deadlineUs;
+        }
+
+        auto startUs = m_clock->nowUs();
+        waitUntil(deadlineUs);
+        auto sleptUs = m_clock->nowUs() - startUs;
+        {
+            std::scoped_lock lock(m_mtx);
+            m_sleptUs = sleptUs;
+        }
+        return sleptUs;
+    }
+
+    //! Predicted GPU bound frame time, 0 if unknown
+    int64_t getPredictedGpuFrameUs()
+    {
+        std::scoped_lock lock(m_mtx);
+        return (int64_t)m_gpuFrameUs;
+    }
+
+    //! Predicted CPU cost of a frame from simulation start to present end, 0 if unknown
+    int64_t getPredictedCpuFrameUs()
+    {
+        std::scoped_lock lock(m_mtx);
+        return (int64_t)m_cpuFrameUs;
+    }
+
+private:
+
+    inline static double ema(double current, double sample)
+    {
+        return current > 0 ? current + (sample - current) * 0.1 : sample;
+    }
+
+    //! NOT thread safe, called under lock
+    void onPresentEnd(int64_t now)
+    {
+        if (m_presentEndUs && m_presentStartUs)
+        {
+            auto intervalUs = now - m_presentEndUs;
+            auto blockedUs = now - m_presentStartUs;
+            if (intervalUs > 0 && intervalUs < kMaxFrameIntervalUs)
+            {
+                if (blockedUs > kPresentBlockedThresholdUs)
+                {
+                    // Swap-chain queue is full, interval is dictated by the GPU
+                    m_gpuFrameUs = ema(m_gpuFrameUs, (double)intervalUs);
+                }
+                else
+                {
+                    // Not blocked, frame could have been as fast as the work done minus our own sleep
+                    m_gpuFrameUs = ema(m_gpuFrameUs, (double)std::max<int64_t>(intervalUs - m_sleptUs, 0));
+                }
+                if (m_simStartUs && now > m_simStartUs)
+                {
+                    m_cpuFrameUs = ema(m_cpuFrameUs, (double)(now - m_simStartUs - std::max<int64_t>(blockedUs, 0)));
+                }
+            }
+        }
+        m_presentEndUs = now;
+    }
+
+    //! NOT thread safe, called under lock
+    int64_t getTargetIntervalUs() const
+    {
+        int64_t intervalUs = m_frameLimitUs;
+        if (m_lowLatency)
+        {
+            intervalUs = std::max(intervalUs, (int64_t)m_gpuFrameUs * (100 - kGpuHeadroomPercent) / 100);
+        }
+        return intervalUs;
+    }
+
+    void waitUntil(int64_t deadlineUs)
+    {
+        int64_t spinUs;
+        {
+            std::scoped_lock lock(m_mtx);
+            spinUs = std::clamp((int64_t)m_oversleepUs + kMinSpinUs, kMinSpinUs, kMaxSpinUs);
+        }
+        auto now = m_clock->nowUs();
+        auto remainingUs = deadlineUs - now;
+        if (remainingUs > spinUs)
+        {
+            auto requestedUs = remainingUs - spinUs;
+            m_clock->sleepUs(requestedUs);
+            auto afterUs = m_clock->nowUs();
+            // Track how much OS oversleeps so we know how early we need to wake up
+            std::scoped_lock lock(m_mtx);
+            m_oversleepUs = ema(m_oversleepUs, (double)std::max<int64_t>(afterUs - now - requestedUs, 0));
+        }
+        while (m_clock->nowUs() < deadlineUs)
+        {
+            m_clock->spin();
+        }
+    }
+
+    std::mutex m_mtx;
+    SteadyPacerClock m_steadyClock{};
+    IPacerClock* m_clock{};
+
+    int64_t m_frameLimitUs{};
+    bool m_lowLatency{};
+
+    int64_t m_simStartUs{};
+    int64_t m_presentStartUs{};
+    int64_t m_presentEndUs{};
+    int64_t m_lastWakeUs{};
+    int64_t m_sleptUs{};
+
+    double m_gpuFrameUs{};
+    double m_cpuFrameUs{};
+    double m_oversleepUs{};
+};
+
+}
+}
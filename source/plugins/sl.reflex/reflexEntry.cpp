@@ -35,6 +35,9 @@
 #include "source/plugins/sl.template/versions.h"
 #include "source/plugins/sl.common/commonInterface.h"
 #include "source/plugins/sl.reflex/pclstats.h"
+#include "source/plugins/sl.reflex/pacer.h"
+#include "source/plugins/sl.reflex/latencyStats.h"
+#include "source/core/sl.file/file.h"
 #include "source/plugins/sl.imgui/imgui.h"
 #include "_artifacts/gitVersion.h"
 #include "external/nvapi/nvapi.h"
@@ -50,14 +53,17 @@ namespace sl
 namespace reflex
 {
 
+//! Values shown on screen, copied on the game thread when they change and only formatted by the UI callback
 struct UIStats
 {
     std::mutex mtx;
-    std::string mode;
-    std::string markers;
-    std::string fpsCap;
-    std::string presentFrame;
-    std::string sleeping;
+    ReflexMode mode{};
+    bool useMarkersToOptimize{};
+    uint32_t frameLimitUs{};
+    double sleepingMs{};
+    bool softwarePacer{};
+    int64_t predictedGpuFrameUs{};
+    int64_t predictedCpuFrameUs{};
 };
 
 //! Our common context
@@ -98,12 +104,22 @@ struct LatencyContext
 
     extra::AverageValueMeter sleepMeter{};
 
+    //! Software pacer used when low-latency mode is not available
+    Pacer pacer{};
+
+    //! Per frame marker timestamps and latency distributions
+    MarkerTimeline timeline{};
+    LatencyHistogram simToPresent{};
+    LatencyHistogram renderSubmitToPresent{};
+    LatencyHistogram inputToPresent{};
+
+    //! Last frame we got present (or render submit on Unity) marker for
+    std::atomic<uint32_t> presentFrameIndex{};
+
     //! Stats initialized or not
     std::atomic<bool> initialized = false;
     std::atomic<bool> enabled = false;
 
-    //! Debug text stats
-    std::string stats;
 };
 }
 
@@ -184,21 +200,122 @@ void updateEmbeddedJSON(json& config)
 }
 
 //! Update stats shown on screen
-void updateStats(uint32_t presentFrameIndex)
+void updateStats()
 {
 #ifndef SL_PRODUCTION
     auto& ctx = (*reflex::getContext());
-    std::string mode[] = { "Off", "On", "On with boost" };
 
     std::scoped_lock lock(ctx.uiStats.mtx);
-    ctx.uiStats.mode = "Mode: " + mode[ctx.constants.mode];
-    ctx.uiStats.markers = extra::format("Optimize with markers: {}", (ctx.constants.useMarkersToOptimize ? "Yes" : "No"));
-    ctx.uiStats.fpsCap = extra::format("FPS cap: {}us", ctx.constants.frameLimitUs);
-    if(presentFrameIndex) ctx.uiStats.presentFrame = extra::format("Present marker frame: {}", presentFrameIndex);
-    ctx.uiStats.sleeping = extra::format("Sleeping: {}ms", ctx.sleepMeter.getMean());
+    ctx.uiStats.mode = ctx.constants.mode;
+    ctx.uiStats.useMarkersToOptimize = ctx.constants.useMarkersToOptimize;
+    ctx.uiStats.frameLimitUs = ctx.constants.frameLimitUs;
+    ctx.uiStats.sleepingMs = ctx.sleepMeter.getMean();
+    ctx.uiStats.softwarePacer = !ctx.lowLatencyAvailable;
+    if (ctx.uiStats.softwarePacer)
+    {
+        ctx.uiStats.predictedGpuFrameUs = ctx.pacer.getPredictedGpuFrameUs();
+        ctx.uiStats.predictedCpuFrameUs = ctx.pacer.getPredictedCpuFrameUs();
+    }
 #endif
 }
 
+//! Feed marker pair latencies for the given frame into histograms
+void updateLatencyStats(uint64_t frame, uint64_t presentEndUs)
+{
+    auto& ctx = (*reflex::getContext());
+    auto addLatency = [&ctx, frame, presentEndUs](ReflexMarker marker, LatencyHistogram& histogram)->void
+    {
+        auto startUs = ctx.timeline.get((uint32_t)marker, frame);
+        if (startUs && startUs <= presentEndUs)
+        {
+            histogram.add(presentEndUs - startUs);
+        }
+    };
+    addLatency(ReflexMarker::eSimulationStart, ctx.simToPresent);
+    addLatency(ReflexMarker::eRenderSubmitStart, ctx.renderSubmitToPresent);
+    addLatency(ReflexMarker::eInputSample, ctx.inputToPresent);
+}
+
+//! Dumps timeline and latency percentiles to a file, on demand only so allocations are fine here
+Result exportLatencyStats(const ReflexStatsExport& request)
+{
+    auto& ctx = (*reflex::getContext());
+
+    if (!request.path)
+    {
+        return Result::eErrorMissingInputParameter;
+    }
+
+    auto stats = std::make_unique<ReflexLatencyStats>();
+    ctx.timeline.copyTo(stats->timeline);
+    ctx.simToPresent.getPercentiles(stats->simToPresent);
+    ctx.renderSubmitToPresent.getPercentiles(stats->renderSubmitToPresent);
+    ctx.inputToPresent.getPercentiles(stats->inputToPresent);
+
+    static const char* kMarkerNames[kReflexTimelineMarkerCount] = 
+    { 
+        "simStart", "simEnd", "renderSubmitStart", "renderSubmitEnd", "presentStart", "presentEnd", "inputSample", "triggerFlash", "pcLatencyPing" 
+    };
+    std::pair<const char*, const ReflexLatencyPercentiles*> latencies[] = 
+    { 
+        {"simToPresent", &stats->simToPresent}, {"renderSubmitToPresent", &stats->renderSubmitToPresent}, {"inputToPresent", &stats->inputToPresent} 
+    };
+
+    std::string contents;
+    if (request.format == ReflexStatsExportFormat::eJSON)
+    {
+        json j;
+        for (auto& [name, p] : latencies)
+        {
+            j["latency"][name] = { {"samples", p->numSamples}, {"meanUs", p->meanUs}, {"p50Us", p->p50Us}, {"p95Us", p->p95Us}, {"p99Us", p->p99Us}, {"maxUs", p->maxUs} };
+        }
+        j["timeline"] = json::array();
+        for (auto& frame : stats->timeline)
+        {
+            if (!frame.frameID) continue;
+            json f = { {"frame", frame.frameID} };
+            for (uint32_t m = 0; m < kReflexTimelineMarkerCount; m++)
+            {
+                f[kMarkerNames[m]] = frame.markerTimeUs[m];
+            }
+            j["timeline"].push_back(f);
+        }
+        contents = j.dump(2);
+    }
+    else
+    {
+        contents = "latency,samples,meanUs,p50Us,p95Us,p99Us,maxUs\n";
+        for (auto& [name, p] : latencies)
+        {
+            contents += extra::format("{},{},{},{},{},{},{}\n", name, p->numSamples, p->meanUs, p->p50Us, p->p95Us, p->p99Us, p->maxUs);
+        }
+        contents += "\nframe";
+        for (auto name : kMarkerNames)
+        {
+            contents += std::string(",") + name;
+        }
+        for (auto& frame : stats->timeline)
+        {
+            if (!frame.frameID) continue;
+            contents += extra::format("\n{}", frame.frameID);
+            for (auto t : frame.markerTimeUs)
+            {
+                contents += extra::format(",{}", t);
+            }
+        }
+    }
+
+    auto file = file::open(request.path, L"wt");
+    if (!file)
+    {
+        return Result::eErrorInvalidParameter;
+    }
+    file::writeLine(file, contents.c_str());
+    file::close(file);
+    SL_LOG_INFO("Exported latency stats to '%S'", request.path);
+    return Result::eOk;
+}
+
 //! Set constants for our plugin (if any, this is optional and should be thread safe)
 Result slSetData(const BaseStructure* inputs, CommandBuffer* cmdBuffer)
 {
@@ -212,11 +329,31 @@ Result slSetData(const BaseStructure* inputs, CommandBuffer* cmdBuffer)
     auto marker = findStruct<ReflexHelper>(inputs);
     auto consts = findStruct<ReflexOptions>(inputs);
     auto frame = findStruct<FrameToken>(inputs);
+    auto exportRequest = findStruct<ReflexStatsExport>(inputs);
+
+    if (exportRequest)
+    {
+        auto res = exportLatencyStats(*exportRequest);
+        if (res != Result::eOk || (!consts && !marker))
+        {
+            return res;
+        }
+    }
     
     if (marker && frame)
     {
         common::EventData evd = { (uint32_t)*marker, *frame };
 
+        if (evd.id < kReflexTimelineMarkerCount)
+        {
+            auto timeUs = getTimeUs();
+            ctx.timeline.record(evd.id, evd.frame, timeUs);
+            if (evd.id == ReflexMarker::ePresentEnd)
+            {
+                updateLatencyStats(evd.frame, timeUs);
+            }
+        }
+
         // Special 'marker' for low latency mode
         if (*marker == (ReflexMarker)kReflexMarkerSleep)
         {
@@ -230,6 +367,11 @@ Result slSetData(const BaseStructure* inputs, CommandBuffer* cmdBuffer)
                 ctx.sleepMeter.end();
 #endif
             }
+            else if (ctx.pacer.isActive())
+            {
+                // No driver support, pace the simulation thread ourselves
+                ctx.sleepMeter.add(ctx.pacer.sleep() / 1000.0);
+            }
         }
         else
         {
@@ -238,12 +380,17 @@ Result slSetData(const BaseStructure* inputs, CommandBuffer* cmdBuffer)
             {
                 CHI_VALIDATE(ctx.compute->setReflexMarker((ReflexMarker)evd.id, evd.frame));
             }
+            else if (!ctx.lowLatencyAvailable)
+            {
+                ctx.pacer.onMarker((ReflexMarker)evd.id);
+            }
 
             // Special case for Unity, it is hard to provide present markers so using render markers
             if (evd.id == ReflexMarker::ePresentStart || (ctx.engine == EngineType::eUnity && evd.id == ReflexMarker::eRenderSubmitStart))
             {
                 api::getContext()->parameters->set(sl::param::latency::kMarkerFrame, evd.frame);
-                updateStats(evd.frame);
+                ctx.presentFrameIndex.store(evd.frame);
+                updateStats();
 
                 // Mark the last frame we were active
                 //
@@ -272,7 +419,7 @@ Result slSetData(const BaseStructure* inputs, CommandBuffer* cmdBuffer)
             // At the moment low latency is only possible on NVDA hw
             if (consts->mode == ReflexMode::eLowLatency || consts->mode == ReflexMode::eLowLatencyWithBoost)
             {
-                SL_LOG_WARN_ONCE("Low-latency modes are only supported on NVIDIA hardware through Reflex, collecting latency stats only");
+                SL_LOG_WARN_ONCE("Low-latency modes are only supported on NVIDIA hardware through Reflex, using software pacer instead");
             }
         }
 
@@ -320,7 +467,9 @@ Result slSetData(const BaseStructure* inputs, CommandBuffer* cmdBuffer)
             {
                 CHI_VALIDATE(ctx.compute->setSleepMode(ctx.constants));
             }
-            updateStats(0);
+            // Pacer always tracks the latest options since availability can change at runtime (failed sleep call)
+            ctx.pacer.setOptions(ctx.constants.frameLimitUs, ctx.constants.mode != ReflexMode::eOff);
+            updateStats();
         }
     }
     
@@ -348,6 +497,16 @@ Result slGetData(const BaseStructure* inputs, BaseStructure* outputs, CommandBuf
     settings->flashIndicatorDriverControlled = ctx.flashIndicatorDriverControlled;
     // Allow host to check Windows messages for the special low latency message
     settings->statsWindowMessage = g_PCLStatsWindowMessage;
+
+    // Optional latency stats, filled in place
+    auto stats = findStruct<ReflexLatencyStats>(outputs);
+    if (stats)
+    {
+        ctx.timeline.copyTo(stats->timeline);
+        ctx.simToPresent.getPercentiles(stats->simToPresent);
+        ctx.renderSubmitToPresent.getPercentiles(stats->renderSubmitToPresent);
+        ctx.inputToPresent.getPercentiles(stats->inputToPresent);
+    }
     return Result::eOk;
 }
 
@@ -388,18 +547,13 @@ bool slOnPluginStartup(const char* jsonConfig, void* device)
 
     //! Plugin manager gives us the device type and the application id
     //! 
-    json& config = *(json*)api::getContext()->loaderConfig;
-    uint32_t deviceType{};
-    int appId{};
-    config.at("appId").get_to(appId);
-    config.at("deviceType").get_to(deviceType);
-    if (config.contains("ngx"))
+    auto& config = api::getContext()->loaderConfig;
+    auto deviceType = config.getDeviceType();
+    int appId = config.getAppId();
+    ctx.engine = config.getEngineType();
+    if (ctx.engine == EngineType::eUnity)
     {
-        config.at("ngx").at("engineType").get_to(ctx.engine);
-        if (ctx.engine == EngineType::eUnity)
-        {
-            SL_LOG_INFO("Detected Unity engine - using render submit markers instead of present to detect current frame");
-        }
+        SL_LOG_INFO("Detected Unity engine - using render submit markers instead of present to detect current frame");
     }
     //! Now let's obtain compute interface if we need to dispatch some compute work
     //! 
@@ -423,8 +577,6 @@ bool slOnPluginStartup(const char* jsonConfig, void* device)
         SL_LOG_HINT("Read 'useMarkersToOptimize' %u from JSON config", ctx.useMarkersToOptimizeOverrideValue);
     }
 
-    updateStats(0);
-
 #ifndef SL_PRODUCTION
     // Check for UI and register our callback
     imgui::ImGUI* ui{};
@@ -437,13 +589,42 @@ bool slOnPluginStartup(const char* jsonConfig, void* device)
             auto v = api::getContext()->pluginVersion;
             if (ui->collapsingHeader(extra::format("sl.reflex v{}", (v.toStr() + "." + GIT_LAST_COMMIT_SHORT)).c_str(), imgui::kTreeNodeFlagDefaultOpen))
             {
-                std::scoped_lock lock(ctx.uiStats.mtx);
-                ui->text(ctx.uiStats.mode.c_str());
-                ui->text(ctx.uiStats.markers.c_str());
-                ui->text(ctx.uiStats.fpsCap.c_str());
-                ui->text(ctx.uiStats.presentFrame.c_str());
-                ui->text(ctx.uiStats.sleeping.c_str());
-                if (finalFrame) ctx.stats = {};
+                // Game thread only copies values, formatting happens here when overlay is visible and expanded
+                UIStats stats;
+                {
+                    std::scoped_lock lock(ctx.uiStats.mtx);
+                    stats.mode = ctx.uiStats.mode;
+                    stats.useMarkersToOptimize = ctx.uiStats.useMarkersToOptimize;
+                    stats.frameLimitUs = ctx.uiStats.frameLimitUs;
+                    stats.sleepingMs = ctx.uiStats.sleepingMs;
+                    stats.softwarePacer = ctx.uiStats.softwarePacer;
+                    stats.predictedGpuFrameUs = ctx.uiStats.predictedGpuFrameUs;
+                    stats.predictedCpuFrameUs = ctx.uiStats.predictedCpuFrameUs;
+                }
+                std::string mode[] = { "Off", "On", "On with boost" };
+                ui->text(("Mode: " + mode[std::min((uint32_t)stats.mode, 2u)]).c_str());
+                ui->text(extra::format("Optimize with markers: {}", (stats.useMarkersToOptimize ? "Yes" : "No")).c_str());
+                ui->text(extra::format("FPS cap: {}us", stats.frameLimitUs).c_str());
+                ui->text(extra::format("Present marker frame: {}", ctx.presentFrameIndex.load()).c_str());
+                auto sleeping = extra::format("Sleeping: {}ms", stats.sleepingMs);
+                if (stats.softwarePacer)
+                {
+                    sleeping += extra::format(" (software pacer, predicted GPU {}us CPU {}us)", stats.predictedGpuFrameUs, stats.predictedCpuFrameUs);
+                }
+                ui->text(sleeping.c_str());
+                std::pair<const char*, const LatencyHistogram*> latencies[] = 
+                { 
+                    {"Sim to present", &ctx.simToPresent}, {"Render submit to present", &ctx.renderSubmitToPresent}, {"Input to present", &ctx.inputToPresent} 
+                };
+                for (auto& [name, histogram] : latencies)
+                {
+                    ReflexLatencyPercentiles p{};
+                    histogram->getPercentiles(p);
+                    if (p.numSamples)
+                    {
+                        ui->text(extra::format("{}: p50 {}us p95 {}us p99 {}us", name, p.p50Us, p.p95Us, p.p99Us).c_str());
+                    }
+                }
             }
         };
         ui->registerRenderCallbacks(renderUI, nullptr);
@@ -503,12 +684,14 @@ SL_EXPORT void* slGetPluginFunction(const char* functionName)
 {
     //! Forward declarations
     bool slOnPluginLoad(sl::param::IParameters * params, const char* loaderJSON, const char** pluginJSON);
+    bool slOnPluginSetLoaderConfig(const void* config, size_t size);
 
     //! Redirect to OTA if any
     SL_EXPORT_OTA;
 
     //! Core API
     SL_EXPORT_FUNCTION(slOnPluginLoad);
+    SL_EXPORT_FUNCTION(slOnPluginSetLoaderConfig);
     SL_EXPORT_FUNCTION(slOnPluginShutdown);
     SL_EXPORT_FUNCTION(slOnPluginStartup);
     SL_EXPORT_FUNCTION(slSetData);
@@ -354,11 +354,9 @@ bool slOnPluginStartup(const char* jsonConfig, void* device)
 
     //! Plugin manager gives us the device type and the application id
     //! 
-    json& config = *(json*)api::getContext()->loaderConfig;
-    uint32_t deviceType{};
-    int appId{};
-    config.at("appId").get_to(appId);
-    config.at("deviceType").get_to(deviceType);
+    auto& config = api::getContext()->loaderConfig;
+    auto deviceType = config.getDeviceType();
+    int appId = config.getAppId();
 
     //! Extra config is always `sl.plugin_name.json` so in our case `sl.template.json`
     //! 
@@ -460,12 +458,14 @@ SL_EXPORT void* slGetPluginFunction(const char* functionName)
 {
     //! Forward declarations
     bool slOnPluginLoad(sl::param::IParameters * params, const char* loaderJSON, const char** pluginJSON);
+    bool slOnPluginSetLoaderConfig(const void* config, size_t size);
 
     //! Redirect to OTA if any
     SL_EXPORT_OTA;
 
     //! Core API
     SL_EXPORT_FUNCTION(slOnPluginLoad);
+    SL_EXPORT_FUNCTION(slOnPluginSetLoaderConfig);
     SL_EXPORT_FUNCTION(slOnPluginShutdown);
     SL_EXPORT_FUNCTION(slOnPluginStartup);
     SL_EXPORT_FUNCTION(slSetConstants);